@@ -0,0 +1,422 @@
+#ifndef HEADER_ONLY_LIBRARY_AHO_CORASICK_H
+#define HEADER_ONLY_LIBRARY_AHO_CORASICK_H
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace header_only_library {
+namespace algorithm {
+
+/**
+ * An Aho-Corasick automaton that finds any number of patterns in
+ * a single pass over the text.
+ *
+ * The automaton is built once as a full DFA over the characters
+ * that actually occur in the patterns (every other character shares
+ * one column) so each text character costs one table lookup.
+ *
+ * find_all() reports matches leftmost-longest and without overlaps,
+ * which is what replacing or tokenizing needs: where several patterns
+ * could match, the one starting first wins and, of those starting
+ * at the same place, the longest. find_overlapping() reports every
+ * occurrence of every pattern instead. Empty patterns never match and
+ * of duplicate patterns only the first is reported.
+ *
+ * While no match is in progress the text is skipped up to the next
+ * character that can start a pattern, with a single std::memchr()
+ * when all of the patterns start with the same character.
+ *
+ * The text may be given as a pointer pair or as anything with data()
+ * and size(), such as strings, string views and ranges.
+ *
+ * Usage:
+ *
+ *	hol::aho_corasick ac{"he", "she", "hers"};
+ *
+ *	ac.find_all(s.data(), s.data() + s.size(), [](auto const& m){
+ *		std::cout << m.pattern << " at " << m.pos << '\n';
+ *	});
+ */
+template<typename CharT>
+class basic_aho_corasick
+{
+public:
+	using char_type = CharT;
+	using string_type = std::basic_string<CharT>;
+
+	//! A matched pattern (by index) and where it was found.
+	struct match
+	{
+		std::size_t pattern;
+		std::size_t pos;
+		std::size_t size;
+	};
+
+	basic_aho_corasick() { build(); }
+
+	template<typename Iter>
+	basic_aho_corasick(Iter beg, Iter end)
+	{
+		for(; beg != end; ++beg)
+			m_patterns.emplace_back(std::begin(*beg), std::end(*beg));
+		build();
+	}
+
+	basic_aho_corasick(std::initializer_list<string_type> patterns)
+	: basic_aho_corasick(std::begin(patterns), std::end(patterns)) {}
+
+	//! The number of patterns.
+	std::size_t size() const { return m_patterns.size(); }
+	bool empty() const { return m_patterns.empty(); }
+
+	string_type const& pattern(std::size_t i) const { return m_patterns[i]; }
+
+	//! The number of automaton states.
+	std::size_t states() const { return m_depth.size(); }
+
+	/**
+	 * Call func(match const&) for every leftmost-longest,
+	 * non-overlapping pattern occurrence in [beg, end),
+	 * in order. Match positions are relative to beg.
+	 */
+	template<typename Func>
+	void find_all(CharT const* beg, CharT const* end, Func func) const
+	{
+		state_id st = root;
+		match m{none, 0, 0}; // the best pending match
+
+		for(auto p = beg;;)
+		{
+			if(st == root && m.pattern == none)
+				p = skip(p, end);
+
+			if(p == end)
+			{
+				if(m.pattern == none)
+					break;
+
+				// nothing can beat the pending match
+				func(m);
+				p = beg + m.pos + m.size;
+				st = root;
+				m.pattern = none;
+				continue;
+			}
+
+			st = next(st, *p++);
+
+			auto const here = std::size_t(p - beg);
+
+			if(m_out[st] != none)
+			{
+				auto const size = m_patterns[m_out[st]].size();
+				auto const pos = here - size;
+
+				if(m.pattern == none || pos < m.pos || (pos == m.pos && size > m.size))
+					m = {m_out[st], pos, size};
+			}
+
+			// every future match starts at or after here - depth
+			if(m.pattern != none && m.pos < here - m_depth[st])
+			{
+				func(m);
+				p = beg + m.pos + m.size;
+				st = root;
+				m.pattern = none;
+			}
+		}
+	}
+
+	template<typename Func>
+	void find_all(string_type const& s, Func func) const
+		{ find_all(s.data(), s.data() + s.size(), func); }
+
+	template<typename Chars, typename Func>
+	auto find_all(Chars const& s, Func func) const
+		-> decltype(void(find_all(s.data(), s.data() + s.size(), func)))
+			{ find_all(s.data(), s.data() + s.size(), func); }
+
+	/**
+	 * Call func(match const&) for every occurrence of every pattern
+	 * in [beg, end), including those that overlap or lie inside longer
+	 * matches. Matches are reported in order of where they end and,
+	 * of those ending at the same place, longest first.
+	 */
+	template<typename Func>
+	void find_overlapping(CharT const* beg, CharT const* end, Func func) const
+	{
+		state_id st = root;
+
+		for(auto p = beg;;)
+		{
+			if(st == root)
+				p = skip(p, end);
+
+			if(p == end)
+				break;
+
+			st = next(st, *p++);
+
+			auto const here = std::size_t(p - beg);
+
+			for(auto hit = m_report[st]; hit != nil; hit = m_chain[hit])
+				func(match{m_out[hit], here - m_depth[hit], m_depth[hit]});
+		}
+	}
+
+	template<typename Func>
+	void find_overlapping(string_type const& s, Func func) const
+		{ find_overlapping(s.data(), s.data() + s.size(), func); }
+
+	template<typename Chars, typename Func>
+	auto find_overlapping(Chars const& s, Func func) const
+		-> decltype(void(find_overlapping(s.data(), s.data() + s.size(), func)))
+			{ find_overlapping(s.data(), s.data() + s.size(), func); }
+
+	//! Every match in [beg, end) (see find_all()).
+	std::vector<match> matches(CharT const* beg, CharT const* end) const
+	{
+		std::vector<match> v;
+		find_all(beg, end, [&](match const& m){ v.push_back(m); });
+		return v;
+	}
+
+	std::vector<match> matches(string_type const& s) const
+		{ return matches(s.data(), s.data() + s.size()); }
+
+	template<typename Chars>
+	auto matches(Chars const& s) const
+		-> decltype(matches(s.data(), s.data() + s.size()))
+			{ return matches(s.data(), s.data() + s.size()); }
+
+	//! Every occurrence in [beg, end) (see find_overlapping()).
+	std::vector<match> overlapping_matches(CharT const* beg, CharT const* end) const
+	{
+		std::vector<match> v;
+		find_overlapping(beg, end, [&](match const& m){ v.push_back(m); });
+		return v;
+	}
+
+	std::vector<match> overlapping_matches(string_type const& s) const
+		{ return overlapping_matches(s.data(), s.data() + s.size()); }
+
+	template<typename Chars>
+	auto overlapping_matches(Chars const& s) const
+		-> decltype(overlapping_matches(s.data(), s.data() + s.size()))
+			{ return overlapping_matches(s.data(), s.data() + s.size()); }
+
+private:
+	using state_id = std::uint32_t;
+	using uchar_type = std::make_unsigned_t<CharT>;
+
+	static constexpr state_id root = 0;
+	static constexpr state_id nil = std::numeric_limits<state_id>::max();
+	static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+	//! The table column for a character, 0 for those in no pattern.
+	std::size_t column(CharT c) const
+	{
+		auto const u = uchar_type(c);
+
+		if(u < m_low.size())
+			return m_low[u];
+
+		auto const pos = std::lower_bound(std::begin(m_high), std::end(m_high), c);
+
+		if(pos == std::end(m_high) || *pos != c)
+			return 0;
+
+		return m_low_columns + std::size_t(pos - std::begin(m_high)) + 1;
+	}
+
+	state_id next(state_id st, CharT c) const
+		{ return m_delta[st * m_columns + column(c)]; }
+
+	//! The first character from p that leaves the root state.
+	CharT const* skip(CharT const* p, CharT const* end) const
+	{
+		if(m_starts == 1)
+		{
+			auto const found = std::char_traits<CharT>::find(p, std::size_t(end - p), m_start);
+			return found ? found : end;
+		}
+
+		while(p != end && next(root, *p) == root)
+			++p;
+
+		return p;
+	}
+
+	void build()
+	{
+		// compact alphabet: one column per distinct pattern character
+		std::vector<CharT> alphabet;
+		for(auto const& p: m_patterns)
+			alphabet.insert(std::end(alphabet), std::begin(p), std::end(p));
+
+		std::sort(std::begin(alphabet), std::end(alphabet));
+		alphabet.erase(std::unique(std::begin(alphabet), std::end(alphabet)), std::end(alphabet));
+
+		m_low.fill(0);
+		m_high.clear();
+
+		m_low_columns = 0;
+		for(auto c: alphabet)
+		{
+			if(uchar_type(c) < m_low.size())
+				m_low[uchar_type(c)] = std::uint16_t(++m_low_columns);
+			else
+				m_high.push_back(c);
+		}
+
+		// high characters are numbered after the low ones
+		m_columns = m_low_columns + m_high.size() + 1;
+
+		// the trie
+		m_delta.assign(m_columns, nil);
+		m_depth.assign(1, 0);
+		m_out.assign(1, none);
+
+		for(std::size_t i = 0; i < m_patterns.size(); ++i)
+		{
+			state_id st = root;
+
+			for(auto c: m_patterns[i])
+			{
+				auto& to = m_delta[st * m_columns + column(c)];
+
+				if(to == nil)
+				{
+					to = state_id(m_depth.size());
+					m_delta.insert(std::end(m_delta), m_columns, nil);
+					m_depth.push_back(m_depth[st] + 1);
+					m_out.push_back(none);
+				}
+
+				st = m_delta[st * m_columns + column(c)];
+			}
+
+			if(st != root && m_out[st] == none)
+				m_out[st] = i;
+		}
+
+		// the characters that begin a pattern
+		m_starts = 0;
+		for(auto const& p: m_patterns)
+		{
+			if(p.empty() || (m_starts && p[0] == m_start))
+				continue;
+
+			m_start = p[0];
+			++m_starts;
+		}
+
+		// breadth first: resolve the failure transitions into the table
+		// and give each state the longest pattern that is its suffix
+		// (m_report and m_chain link the states that end a pattern
+		// through the failure transitions for find_overlapping())
+		std::vector<state_id> fail(m_depth.size(), root);
+
+		m_report.assign(m_depth.size(), nil);
+		m_chain.assign(m_depth.size(), nil);
+		std::vector<state_id> queue;
+		queue.reserve(m_depth.size());
+
+		for(std::size_t c = 0; c < m_columns; ++c)
+		{
+			auto& to = m_delta[root * m_columns + c];
+
+			if(to == nil)
+				to = root;
+			else
+				queue.push_back(to);
+		}
+
+		for(std::size_t i = 0; i < queue.size(); ++i)
+		{
+			auto const st = queue[i];
+
+			m_chain[st] = m_report[fail[st]];
+			m_report[st] = m_out[st] == none ? m_chain[st] : st;
+
+			if(m_out[st] == none)
+				m_out[st] = m_out[fail[st]];
+
+			for(std::size_t c = 0; c < m_columns; ++c)
+			{
+				auto& to = m_delta[st * m_columns + c];
+				auto const via_fail = m_delta[fail[st] * m_columns + c];
+
+				if(to == nil)
+					to = via_fail;
+				else
+				{
+					fail[to] = via_fail;
+					queue.push_back(to);
+				}
+			}
+		}
+	}
+
+	std::vector<string_type> m_patterns;
+
+	std::array<std::uint16_t, 256> m_low; // columns of characters below 256
+	std::vector<CharT> m_high;            // sorted characters above 255
+	std::size_t m_low_columns = 0;
+	std::size_t m_columns = 1;
+
+	std::vector<state_id> m_delta;    // states x columns
+	std::vector<std::uint32_t> m_depth;
+	std::vector<std::size_t> m_out;   // longest pattern ending here or none
+	std::vector<state_id> m_report;   // this or the nearest suffix state ending a pattern
+	std::vector<state_id> m_chain;    // the next such state after this one
+
+	CharT m_start = CharT();          // the first character of every pattern
+	std::size_t m_starts = 0;         // when this is 1
+};
+
+template<typename CharT>
+constexpr typename basic_aho_corasick<CharT>::state_id basic_aho_corasick<CharT>::root;
+
+template<typename CharT>
+constexpr typename basic_aho_corasick<CharT>::state_id basic_aho_corasick<CharT>::nil;
+
+template<typename CharT>
+constexpr std::size_t basic_aho_corasick<CharT>::none;
+
+using aho_corasick = basic_aho_corasick<char>;
+using waho_corasick = basic_aho_corasick<wchar_t>;
+using u16aho_corasick = basic_aho_corasick<char16_t>;
+using u32aho_corasick = basic_aho_corasick<char32_t>;
+
+} // namespace algorithm
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_AHO_CORASICK_H
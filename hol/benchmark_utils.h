@@ -0,0 +1,377 @@
+#ifndef HEADER_ONLY_LIBRARY_BENCHMARK_UTILS_H
+#define HEADER_ONLY_LIBRARY_BENCHMARK_UTILS_H
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "from_chars.h"
+#include "timers.h"
+
+/**
+ * Usage:
+ *
+ * int main(int argc, char* argv[])
+ * {
+ *     hol::benchmark_runner bench(argc, argv); // --csv (default), --json, --filter=text
+ *
+ *     std::string s = "a b c";
+ *
+ *     bench.run("split", [&]{
+ *         hol::do_not_optimize(hol::split(s));
+ *     });
+ *
+ *     bench.report(); // to std::cout
+ * }
+ */
+
+namespace header_only_library {
+namespace benchmark_utils {
+
+#ifdef __unix__
+using default_timer = timers::LinuxTimer;
+#else
+using default_timer = timers::StdTimer;
+#endif
+
+/**
+ * Prevent the compiler from optimizing away the calculation
+ * of `value`.
+ */
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+#ifdef __GNUC__
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile char const* sink;
+	sink = reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+/**
+ * Force the compiler to assume all memory may have
+ * been read and written.
+ */
+inline void clobber_memory()
+{
+#ifdef __GNUC__
+	asm volatile("" : : : "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+struct benchmark_options
+{
+	std::size_t warmup_reps = 3;
+	std::size_t reps = 25;
+	//! Iterations per rep are increased until a rep takes at least this long.
+	double min_rep_nsecs = 2000000.0;
+	//! Reps outside the Tukey fences (k times the interquartile range) are rejected.
+	double outlier_k = 1.5;
+};
+
+/**
+ * All times are nanoseconds per iteration calculated over the
+ * reps that were not rejected as outliers.
+ */
+struct benchmark_result
+{
+	std::string name;
+	std::size_t iterations = 0; // per rep
+	std::size_t reps = 0;
+	std::size_t outliers = 0;
+	double min = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+	double max = 0.0;
+	double stddev = 0.0;
+};
+
+namespace detail {
+
+inline double quantile(std::vector<double> const& sorted, double q)
+{
+	if(sorted.empty())
+		return 0.0;
+
+	auto pos = q * double(sorted.size() - 1);
+	auto lo = std::size_t(pos);
+	auto hi = std::min(lo + 1, sorted.size() - 1);
+
+	return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - double(lo));
+}
+
+inline void write_json_string(std::ostream& os, std::string const& s)
+{
+	os << '"';
+	for(auto c: s)
+	{
+		if(c == '"' || c == '\\')
+			os << '\\';
+		os << c;
+	}
+	os << '"';
+}
+
+//! Quote CSV fields containing separators or quotes (RFC 4180).
+inline void write_csv_string(std::ostream& os, std::string const& s)
+{
+	if(s.find_first_of(",\"\r\n") == std::string::npos)
+	{
+		os << s;
+		return;
+	}
+
+	os << '"';
+	for(auto c: s)
+	{
+		if(c == '"')
+			os << '"';
+		os << c;
+	}
+	os << '"';
+}
+
+} // namespace detail
+
+/**
+ * Summarize the per-iteration times of each rep, rejecting outliers.
+ */
+inline benchmark_result summarize(std::string const& name, std::size_t iterations,
+	std::vector<double> samples, double outlier_k = 1.5)
+{
+	benchmark_result r;
+	r.name = name;
+	r.iterations = iterations;
+
+	if(samples.empty())
+		return r;
+
+	std::sort(std::begin(samples), std::end(samples));
+
+	auto q1 = detail::quantile(samples, 0.25);
+	auto q3 = detail::quantile(samples, 0.75);
+	auto lo = q1 - outlier_k * (q3 - q1);
+	auto hi = q3 + outlier_k * (q3 - q1);
+
+	auto beg = std::lower_bound(std::begin(samples), std::end(samples), lo);
+	auto end = std::upper_bound(beg, std::end(samples), hi);
+
+	r.outliers = samples.size() - std::size_t(end - beg);
+	samples.assign(beg, end);
+
+	r.reps = samples.size();
+	r.min = samples.front();
+	r.max = samples.back();
+	r.median = detail::quantile(samples, 0.5);
+	r.mean = std::accumulate(std::begin(samples), std::end(samples), 0.0) / double(samples.size());
+
+	double var = 0.0;
+	for(auto s: samples)
+		var += (s - r.mean) * (s - r.mean);
+
+	r.stddev = samples.size() > 1 ? std::sqrt(var / double(samples.size() - 1)) : 0.0;
+
+	return r;
+}
+
+template<typename TimerType = default_timer>
+class basic_benchmark_runner
+{
+public:
+	enum class format { csv, json };
+
+	basic_benchmark_runner(benchmark_options const& opts = {}): opts(opts) {}
+
+	/**
+	 * Options from the command line:
+	 *
+	 * --csv          CSV output (default)
+	 * --json         JSON output
+	 * --filter=text  only run benchmarks whose name contains `text`
+	 * --reps=n       number of measured reps
+	 */
+	basic_benchmark_runner(int argc, char* argv[], benchmark_options const& opts = {})
+	: opts(opts)
+	{
+		for(int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+
+			if(arg == "--csv")
+				fmt = format::csv;
+			else if(arg == "--json")
+				fmt = format::json;
+			else if(!arg.compare(0, 9, "--filter="))
+				filter = arg.substr(9);
+			else if(!arg.compare(0, 7, "--reps="))
+				parse_reps(arg);
+		}
+	}
+
+	/**
+	 * Time `func` and record the result. `func` is called
+	 * repeatedly so it must be repeatable.
+	 *
+	 * @return A copy of the recorded result, or a result with
+	 * zero `reps` if `name` was excluded by `--filter`.
+	 */
+	template<typename Func>
+	benchmark_result run(std::string const& name, Func&& func)
+	{
+		if(!filter.empty() && name.find(filter) == std::string::npos)
+		{
+			benchmark_result skipped;
+			skipped.name = name;
+			return skipped;
+		}
+
+		TimerType timer;
+
+		auto time_rep = [&](std::size_t iterations)
+		{
+			timer.start();
+			for(std::size_t i = 0; i < iterations; ++i)
+			{
+				func();
+				clobber_memory();
+			}
+			timer.stop();
+			return double(timer.nsecs());
+		};
+
+		std::size_t iterations = 1;
+
+		while(time_rep(iterations) < opts.min_rep_nsecs && iterations < (std::size_t(1) << 30))
+			iterations *= 2;
+
+		for(std::size_t i = 0; i < opts.warmup_reps; ++i)
+			time_rep(iterations);
+
+		std::vector<double> samples;
+		samples.reserve(opts.reps);
+
+		for(std::size_t i = 0; i < opts.reps; ++i)
+			samples.push_back(time_rep(iterations) / double(iterations));
+
+		results.push_back(summarize(name, iterations, std::move(samples), opts.outlier_k));
+
+		return results.back();
+	}
+
+	std::vector<benchmark_result> const& get_results() const { return results; }
+
+	void report(std::ostream& os = std::cout) const
+	{
+		if(fmt == format::json)
+			write_json(os);
+		else
+			write_csv(os);
+	}
+
+	void write_csv(std::ostream& os) const
+	{
+		os << "name,iterations,reps,outliers,min_ns,median_ns,mean_ns,max_ns,stddev_ns\n";
+
+		auto flags = os.flags();
+		os << std::fixed << std::setprecision(3);
+
+		for(auto const& r: results)
+		{
+			detail::write_csv_string(os, r.name);
+			os << ',' << r.iterations << ',' << r.reps << ',' << r.outliers;
+			os << ',' << r.min << ',' << r.median << ',' << r.mean << ',' << r.max << ',' << r.stddev << '\n';
+		}
+
+		os.flags(flags);
+	}
+
+	void write_json(std::ostream& os) const
+	{
+		auto flags = os.flags();
+		os << std::fixed << std::setprecision(3);
+
+		os << "[";
+
+		char const* sep = "\n";
+
+		for(auto const& r: results)
+		{
+			os << sep << "{\"name\":";
+			detail::write_json_string(os, r.name);
+			os << ",\"iterations\":" << r.iterations;
+			os << ",\"reps\":" << r.reps;
+			os << ",\"outliers\":" << r.outliers;
+			os << ",\"min_ns\":" << r.min;
+			os << ",\"median_ns\":" << r.median;
+			os << ",\"mean_ns\":" << r.mean;
+			os << ",\"max_ns\":" << r.max;
+			os << ",\"stddev_ns\":" << r.stddev << '}';
+			sep = ",\n";
+		}
+
+		os << "\n]\n";
+
+		os.flags(flags);
+	}
+
+private:
+	//! A bad `--reps=` is reported and the default kept.
+	void parse_reps(std::string const& arg)
+	{
+		auto const first = arg.data() + 7;
+		auto const last = arg.data() + arg.size();
+
+		long long reps;
+		auto const r = string_conversions::scan_integer(first, last, reps);
+
+		if(r.ec != std::errc() || r.ptr != last || reps < 1)
+		{
+			std::cerr << "ignoring bad option: " << arg << '\n';
+			return;
+		}
+
+		opts.reps = std::size_t(reps);
+	}
+
+	benchmark_options opts;
+	format fmt = format::csv;
+	std::string filter;
+	std::vector<benchmark_result> results;
+};
+
+using benchmark_runner = basic_benchmark_runner<>;
+
+} // namespace benchmark_utils
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_BENCHMARK_UTILS_H
@@ -0,0 +1,345 @@
+#ifndef HEADER_ONLY_LIBRARY_LATENCY_HISTOGRAM_H
+#define HEADER_ONLY_LIBRARY_LATENCY_HISTOGRAM_H
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "simple_logger.h"
+#include "timers.h"
+
+/**
+ * Usage:
+ *
+ * hol::latency_histogram h;
+ *
+ * for(auto& job: jobs)
+ * {
+ *     auto scope = h.time_scope(); // records on scope exit
+ *     job();
+ * }
+ *
+ * h.log_summary("jobs"); // I: jobs: n=1000 min=80ns p50=1.2us p99=...
+ *
+ * Histograms recorded by separate threads can be combined with merge().
+ */
+
+namespace header_only_library {
+namespace timers {
+
+/**
+ * Fixed memory log-linear histogram of nanosecond latencies.
+ *
+ * Values below 2^SubBucketBits are counted exactly, above that each
+ * power of two range is divided into 2^(SubBucketBits - 1) linear
+ * sub-buckets giving a relative error of at most 1/2^(SubBucketBits - 1).
+ *
+ * record() is lock-free so a histogram may be shared between threads.
+ */
+template<unsigned SubBucketBits = 8>
+class basic_latency_histogram
+{
+	static_assert(SubBucketBits > 1 && SubBucketBits < 32, "SubBucketBits out of range");
+
+	static constexpr std::uint64_t sub_buckets = std::uint64_t(1) << SubBucketBits;
+	static constexpr std::uint64_t half_buckets = sub_buckets / 2;
+
+public:
+	using value_type = std::uint64_t;
+
+	static constexpr std::size_t bucket_count = std::size_t((66 - SubBucketBits) * half_buckets);
+
+	basic_latency_histogram() { clear(); }
+
+	basic_latency_histogram(basic_latency_histogram const& other)
+	{
+		clear();
+		merge(other);
+	}
+
+	basic_latency_histogram& operator=(basic_latency_histogram const& other)
+	{
+		if(this != &other)
+		{
+			clear();
+			merge(other);
+		}
+		return *this;
+	}
+
+	//! Not safe to call while other threads are recording.
+	void clear()
+	{
+		for(auto& count: counts)
+			count.store(0, std::memory_order_relaxed);
+
+		total.store(0, std::memory_order_relaxed);
+		sum.store(0, std::memory_order_relaxed);
+		lowest.store(std::numeric_limits<value_type>::max(), std::memory_order_relaxed);
+		highest.store(0, std::memory_order_relaxed);
+	}
+
+	void record(value_type ns, std::uint64_t n = 1) noexcept
+	{
+		counts[index_of(ns)].fetch_add(n, std::memory_order_relaxed);
+		total.fetch_add(n, std::memory_order_relaxed);
+		sum.fetch_add(ns * n, std::memory_order_relaxed);
+
+		auto lo = lowest.load(std::memory_order_relaxed);
+		while(ns < lo && !lowest.compare_exchange_weak(lo, ns, std::memory_order_relaxed)) {}
+
+		auto hi = highest.load(std::memory_order_relaxed);
+		while(ns > hi && !highest.compare_exchange_weak(hi, ns, std::memory_order_relaxed)) {}
+	}
+
+	template<typename TimerImpl>
+	void record(Timer<TimerImpl> const& timer) noexcept
+	{
+		auto ns = timer.nsecs();
+		record(ns > 0 ? value_type(ns) : 0);
+	}
+
+	/**
+	 * Add all the samples from `other` (typically a per-thread histogram)
+	 * to this one.
+	 */
+	void merge(basic_latency_histogram const& other)
+	{
+		for(std::size_t i = 0; i < bucket_count; ++i)
+			if(auto n = other.counts[i].load(std::memory_order_relaxed))
+				counts[i].fetch_add(n, std::memory_order_relaxed);
+
+		total.fetch_add(other.count(), std::memory_order_relaxed);
+		sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		auto o_lo = other.lowest.load(std::memory_order_relaxed);
+		auto lo = lowest.load(std::memory_order_relaxed);
+		while(o_lo < lo && !lowest.compare_exchange_weak(lo, o_lo, std::memory_order_relaxed)) {}
+
+		auto o_hi = other.highest.load(std::memory_order_relaxed);
+		auto hi = highest.load(std::memory_order_relaxed);
+		while(o_hi > hi && !highest.compare_exchange_weak(hi, o_hi, std::memory_order_relaxed)) {}
+	}
+
+	std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+	bool empty() const { return !count(); }
+
+	value_type min() const { return empty() ? 0 : lowest.load(std::memory_order_relaxed); }
+	value_type max() const { return highest.load(std::memory_order_relaxed); }
+
+	double mean() const
+	{
+		return empty() ? 0.0 : double(sum.load(std::memory_order_relaxed)) / double(count());
+	}
+
+	/**
+	 * The value below which `p` percent of the recorded samples fall,
+	 * accurate to the resolution of the bucket it lands in.
+	 * @param p Percentile in the range [0, 100].
+	 */
+	value_type percentile(double p) const
+	{
+		auto n = count();
+
+		if(!n)
+			return 0;
+
+		if(p >= 100.0)
+			return max();
+
+		auto rank = std::uint64_t(p / 100.0 * double(n) + 0.5);
+
+		if(!rank)
+			rank = 1;
+
+		std::uint64_t seen = 0;
+
+		for(std::size_t i = 0; i < bucket_count; ++i)
+		{
+			seen += counts[i].load(std::memory_order_relaxed);
+
+			if(seen >= rank)
+				return std::min(std::max(highest_equivalent(i), min()), max());
+		}
+
+		return max();
+	}
+
+	value_type p50() const { return percentile(50.0); }
+	value_type p90() const { return percentile(90.0); }
+	value_type p99() const { return percentile(99.0); }
+	value_type p999() const { return percentile(99.9); }
+
+	/**
+	 * One line summary of the form:
+	 *
+	 * n=1000 min=80ns mean=1.31us p50=1.2us p99=8.13us p999=12.1us max=15us
+	 */
+	std::string summary() const
+	{
+		std::ostringstream oss;
+		oss << *this;
+		return oss.str();
+	}
+
+	/**
+	 * Send summary() to the simple_logger.
+	 */
+	void log_summary(std::string const& label,
+		simple_logger::LOG level = simple_logger::LOG::I) const
+	{
+		level << label << ": " << summary();
+	}
+
+	/**
+	 * Time from construction to destruction and record the result.
+	 */
+	template<typename TimerImpl = StdTimerImpl>
+	class scoped_timer
+	{
+	public:
+		explicit scoped_timer(basic_latency_histogram& h): h(&h) { timer.start(); }
+
+		scoped_timer(scoped_timer&& other): h(other.h), timer(other.timer)
+			{ other.h = nullptr; }
+
+		scoped_timer(scoped_timer const&) = delete;
+		scoped_timer& operator=(scoped_timer const&) = delete;
+
+		~scoped_timer()
+		{
+			if(!h)
+				return;
+
+			timer.stop();
+			h->record(timer);
+		}
+
+	private:
+		basic_latency_histogram* h;
+		Timer<TimerImpl> timer;
+	};
+
+	template<typename TimerImpl = StdTimerImpl>
+	scoped_timer<TimerImpl> time_scope()
+	{
+		return scoped_timer<TimerImpl>(*this);
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, basic_latency_histogram const& h)
+	{
+		os << "n=" << h.count();
+		os << " min="; write_nsecs(os, double(h.min()));
+		os << " mean="; write_nsecs(os, h.mean());
+		os << " p50="; write_nsecs(os, double(h.p50()));
+		os << " p99="; write_nsecs(os, double(h.p99()));
+		os << " p999="; write_nsecs(os, double(h.p999()));
+		os << " max="; write_nsecs(os, double(h.max()));
+		return os;
+	}
+
+	static std::size_t index_of(value_type ns) noexcept
+	{
+		if(ns < sub_buckets)
+			return std::size_t(ns);
+
+		auto shift = msb(ns) - SubBucketBits + 1;
+		return std::size_t((shift * half_buckets) + (ns >> shift));
+	}
+
+	static value_type lowest_equivalent(std::size_t i) noexcept
+	{
+		if(i < sub_buckets)
+			return value_type(i);
+
+		auto shift = (i / half_buckets) - 1;
+		return value_type(i - (shift * half_buckets)) << shift;
+	}
+
+	static value_type highest_equivalent(std::size_t i) noexcept
+	{
+		if(i < sub_buckets)
+			return value_type(i);
+
+		auto shift = (i / half_buckets) - 1;
+		return ((value_type(i - (shift * half_buckets)) + 1) << shift) - 1;
+	}
+
+private:
+	static unsigned msb(value_type v) noexcept
+	{
+#ifdef __GNUC__
+		return 63U - unsigned(__builtin_clzll(v));
+#else
+		unsigned n = 0;
+		while(v >>= 1)
+			++n;
+		return n;
+#endif
+	}
+
+	static void write_nsecs(std::ostream& os, double ns)
+	{
+		static char const* const units[] = {"ns", "us", "ms", "s"};
+
+		auto u = 0U;
+		for(; u < 3 && ns >= 999.5; ++u)
+			ns /= 1000.0;
+
+		auto flags = os.flags();
+		auto precision = os.precision();
+
+		os << std::defaultfloat << std::setprecision(3) << ns << units[u];
+
+		os.flags(flags);
+		os.precision(precision);
+	}
+
+	std::array<std::atomic<std::uint64_t>, bucket_count> counts;
+	std::atomic<std::uint64_t> total;
+	std::atomic<std::uint64_t> sum;
+	std::atomic<value_type> lowest;
+	std::atomic<value_type> highest;
+};
+
+template<unsigned SubBucketBits>
+constexpr std::uint64_t basic_latency_histogram<SubBucketBits>::sub_buckets;
+
+template<unsigned SubBucketBits>
+constexpr std::uint64_t basic_latency_histogram<SubBucketBits>::half_buckets;
+
+template<unsigned SubBucketBits>
+constexpr std::size_t basic_latency_histogram<SubBucketBits>::bucket_count;
+
+using latency_histogram = basic_latency_histogram<>;
+
+} // namespace timers
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_LATENCY_HISTOGRAM_H
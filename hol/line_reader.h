@@ -0,0 +1,262 @@
+#ifndef HEADER_ONLY_LIBRARY_LINE_READER_H
+#define HEADER_ONLY_LIBRARY_LINE_READER_H
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "srange.h"
+
+namespace header_only_library {
+namespace string_utils {
+
+/**
+ * Reads delimited lines from a file descriptor or a std::streambuf
+ * through one large reusable buffer. Each line is handed out as a view
+ * into that buffer so no line is ever allocated or copied (apart from
+ * moving a partial line to the front of the buffer before a refill).
+ *
+ * A line view is only valid until the next line is read.
+ *
+ * Usage:
+ *
+ *	hol::line_reader reader{"huge.log"};
+ *
+ *	for(auto line: reader)
+ *		process(line); // basic_srange<char const>, without the '\n'
+ *
+ * Lines longer than the buffer make it grow. The final line
+ * need not be terminated by the delimiter.
+ */
+class line_reader
+{
+public:
+	using line_type = range::basic_srange<char const>;
+
+	static constexpr std::size_t default_buffer_size = 1024 * 1024;
+
+#ifdef __unix__
+
+	/**
+	 * Read from an open file descriptor, which
+	 * remains owned by the caller.
+	 */
+	explicit line_reader(int fd, std::size_t buffer_size = default_buffer_size, char delim = '\n')
+	: fd(fd), buf(std::max(buffer_size, std::size_t(1))), delim(delim) {}
+
+	/**
+	 * Open and read from a file.
+	 */
+	explicit line_reader(std::string const& filename,
+		std::size_t buffer_size = default_buffer_size, char delim = '\n')
+	: line_reader(::open(filename.c_str(), O_RDONLY|O_CLOEXEC), buffer_size, delim)
+	{
+		if(fd == -1)
+			throw std::runtime_error(filename + ": " + std::strerror(errno));
+
+		owns_fd = true;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+		::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	}
+
+#endif // __unix__
+
+	explicit line_reader(std::streambuf* sb, std::size_t buffer_size = default_buffer_size, char delim = '\n')
+	: sb(sb), buf(std::max(buffer_size, std::size_t(1))), delim(delim) {}
+
+	explicit line_reader(std::istream& is, std::size_t buffer_size = default_buffer_size, char delim = '\n')
+	: line_reader(is.rdbuf(), buffer_size, delim) {}
+
+	line_reader(line_reader const&) = delete;
+	line_reader& operator=(line_reader const&) = delete;
+
+	~line_reader()
+	{
+#ifdef __unix__
+		if(owns_fd)
+			::close(fd);
+#endif
+	}
+
+	/**
+	 * Read the next line.
+	 * @return false when there are no more lines.
+	 */
+	bool next(line_type& line)
+	{
+		for(;;)
+		{
+			auto pos = static_cast<char const*>(std::memchr(buf.data() + head + scanned,
+				delim, tail - head - scanned));
+
+			if(pos)
+			{
+				line = line_type(buf.data() + head, pos);
+				head = std::size_t(pos - buf.data()) + 1;
+				scanned = 0;
+				return true;
+			}
+
+			scanned = tail - head;
+
+			if(eof)
+			{
+				if(head == tail)
+					return false;
+
+				line = line_type(buf.data() + head, buf.data() + tail);
+				head = tail;
+				scanned = 0;
+				return true;
+			}
+
+			fill();
+		}
+	}
+
+#if __cplusplus >= 201703L
+	bool next(std::string_view& line)
+	{
+		line_type r;
+
+		if(!next(r))
+			return false;
+
+		line = {r.data(), r.size()};
+		return true;
+	}
+#endif
+
+	class iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = line_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = line_type const*;
+		using reference = line_type const&;
+
+		iterator() = default;
+
+		reference operator*() const { return line; }
+		pointer operator->() const { return &line; }
+
+		iterator& operator++()
+		{
+			if(!reader->next(line))
+				reader = nullptr;
+			return *this;
+		}
+
+		bool operator==(iterator const& other) const { return reader == other.reader; }
+		bool operator!=(iterator const& other) const { return !(*this == other); }
+
+	private:
+		friend class line_reader;
+		explicit iterator(line_reader* reader): reader(reader) { ++(*this); }
+
+		line_reader* reader = nullptr;
+		line_type line;
+	};
+
+	//! Input iteration: each reader can be iterated through only once.
+	iterator begin() { return iterator(this); }
+	iterator end() { return {}; }
+
+private:
+	//! Make room and read more data into the buffer.
+	void fill()
+	{
+		if(head)
+		{
+			std::memmove(buf.data(), buf.data() + head, tail - head);
+			tail -= head;
+			head = 0;
+		}
+
+		if(tail == buf.size())
+			buf.resize(buf.size() * 2);
+
+		auto n = read_some(buf.data() + tail, buf.size() - tail);
+
+		if(!n)
+			eof = true;
+
+		tail += n;
+	}
+
+	std::size_t read_some(char* p, std::size_t n)
+	{
+		if(sb)
+			return std::size_t(sb->sgetn(p, std::streamsize(n)));
+
+#ifdef __unix__
+		for(;;)
+		{
+			auto got = ::read(fd, p, n);
+
+			if(got != -1)
+				return std::size_t(got);
+
+			if(errno != EINTR)
+				throw std::runtime_error(std::string("read: ") + std::strerror(errno));
+		}
+#else
+		return 0;
+#endif
+	}
+
+	int fd = -1;
+	bool owns_fd = false;
+	std::streambuf* sb = nullptr;
+
+	std::vector<char> buf;
+	std::size_t head = 0;    // start of the unread data
+	std::size_t tail = 0;    // end of the unread data
+	std::size_t scanned = 0; // unread data already searched for delim
+	bool eof = false;
+	char delim;
+};
+
+} // namespace string_utils
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_LINE_READER_H
@@ -0,0 +1,181 @@
+#ifndef HEADER_ONLY_LIBRARY_MAPPED_FILE_H
+#define HEADER_ONLY_LIBRARY_MAPPED_FILE_H
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "srange.h"
+
+namespace header_only_library {
+namespace string_utils {
+
+#ifdef __unix__
+
+/**
+ * A whole file memory mapped read-only, for zero-copy parsing.
+ *
+ * Usage:
+ *
+ *	hol::mapped_file mf{"data.csv", hol::mapped_file::sequential};
+ *
+ *	for(auto line: hol::split(mf.as_srange(), "\n"))
+ *		for(auto field: hol::split(line, ","))
+ *			process(field);
+ *
+ * The file must not be truncated by anyone while it is mapped.
+ */
+class mapped_file
+{
+public:
+	//! Hints passed on to madvise(). They may be combined with |.
+	enum advice: unsigned
+	{
+		normal = 0,
+		sequential = 1 << 0, //!< read ahead aggressively, drop pages once read
+		random = 1 << 1,     //!< no read ahead
+		willneed = 1 << 2,   //!< start reading the whole file in now
+		hugepages = 1 << 3,  //!< back the mapping with huge pages where supported
+	};
+
+	mapped_file() = default;
+
+	explicit mapped_file(std::string const& filename, unsigned advice = normal)
+	{
+		auto fd = ::open(filename.c_str(), O_RDONLY|O_CLOEXEC);
+
+		if(fd == -1)
+			throw std::runtime_error(filename + ": " + std::strerror(errno));
+
+		struct stat st;
+
+		if(::fstat(fd, &st) == -1)
+		{
+			auto error = errno;
+			::close(fd);
+			throw std::runtime_error(filename + ": " + std::strerror(error));
+		}
+
+		if(st.st_size)
+		{
+			auto addr = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if(addr == MAP_FAILED)
+			{
+				auto error = errno;
+				::close(fd);
+				throw std::runtime_error(filename + ": " + std::strerror(error));
+			}
+
+			beg = static_cast<char const*>(addr);
+			len = std::size_t(st.st_size);
+		}
+
+		::close(fd);
+
+		advise(advice);
+	}
+
+	mapped_file(mapped_file&& mf) noexcept
+	: beg(std::exchange(mf.beg, nullptr)), len(std::exchange(mf.len, 0)) {}
+
+	mapped_file& operator=(mapped_file&& mf) noexcept
+	{
+		std::swap(beg, mf.beg);
+		std::swap(len, mf.len);
+		return *this;
+	}
+
+	mapped_file(mapped_file const&) = delete;
+	mapped_file& operator=(mapped_file const&) = delete;
+
+	~mapped_file() { if(beg) ::munmap(const_cast<char*>(beg), len); }
+
+	/**
+	 * Change the paging hints for the mapping. The hints are
+	 * only advisory so failures are ignored.
+	 */
+	void advise(unsigned advice)
+	{
+		if(!beg)
+			return;
+
+		auto addr = const_cast<char*>(beg);
+
+		if(advice & sequential)
+			::madvise(addr, len, MADV_SEQUENTIAL);
+
+		if(advice & random)
+			::madvise(addr, len, MADV_RANDOM);
+
+		if(advice & willneed)
+			::madvise(addr, len, MADV_WILLNEED);
+
+#ifdef MADV_HUGEPAGE
+		if(advice & hugepages)
+			::madvise(addr, len, MADV_HUGEPAGE);
+#endif
+	}
+
+	char const* data() const { return beg; }
+	std::size_t size() const { return len; }
+	bool empty() const { return !len; }
+
+	char const* begin() const { return beg; }
+	char const* end() const { return beg + len; }
+
+	range::basic_range<char const> as_range() const
+		{ return range::basic_range<char const>(beg, len); }
+
+	range::basic_srange<char const> as_srange() const
+		{ return range::basic_srange<char const>(beg, len); }
+
+#if __cplusplus >= 201703L
+	std::string_view as_string_view() const { return {beg, len}; }
+	operator std::string_view() const { return as_string_view(); }
+#endif
+
+private:
+	char const* beg = nullptr;
+	std::size_t len = 0;
+};
+
+#endif // __unix__
+
+} // namespace string_utils
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_MAPPED_FILE_H
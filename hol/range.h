@@ -154,7 +154,7 @@ public:
 		{
 			// &*beg => UB when beg == end
 			this->m_beg = &*beg;
-			this->m_end = m_beg = std::distance(beg, end);
+			this->m_end = this->m_beg + std::distance(beg, end);
 		}
 	}
 
@@ -408,6 +408,9 @@ void clear(basic_range<T>& r) { r = r.subrange(0, 0); }
 template<typename From, typename To>
 void copy(basic_range<From> src, basic_range<To> dst, std::size_t pos = 0)
 {
+	if(pos > src.size())
+		HOL_RANGE_EXCEPTION_POLICY("bad position: " << pos << " > " << src.size());
+
 	auto beg = std::begin(src) + pos;
 	auto end = std::end(src);
 	if(beg + dst.size() < end)
@@ -505,7 +508,7 @@ using wrange_istream = basic_range_istream<wchar_t>;
 using u16range_istream = basic_range_istream<char16_t>;
 using u32range_istream = basic_range_istream<char32_t>;
 
-template<typename CharT, typename Traits = std::char_traits<CharT>>
+template<typename CharT, typename Traits>
 basic_range_istream<CharT, Traits>&
 getline(basic_range_istream<CharT, Traits>& is, basic_range<CharT>& sp, CharT delim)
 {
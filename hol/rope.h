@@ -2,334 +2,1451 @@
 #define HEADER_ONLY_LIBRARY_ROPE_H
 
 #include <hol/misc_utils.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <string>
-
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __unix__
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+#include "range.h"
 #include "zstring_utils.h"
 
 namespace header_only_library {
 namespace rope_utils {
+namespace detail {
+
+/**
+ * Does `c` begin a code point? (Not a UTF-8 continuation byte
+ * or a UTF-16 low surrogate.)
+ */
+template<typename CharT>
+bool is_code_point_start(CharT c)
+{
+	switch(sizeof(CharT))
+	{
+		case 1: return (std::uint8_t(c) & 0xC0) != 0x80;
+		case 2: return std::uint16_t(c) < 0xDC00 || std::uint16_t(c) > 0xDFFF;
+	}
+	return true;
+}
 
+template<typename CharT>
+std::size_t count_newlines(CharT const* p, std::size_t n)
+{
+	return std::size_t(std::count(p, p + n, CharT('\n')));
+}
+
+template<typename CharT>
+std::size_t count_code_points(CharT const* p, std::size_t n)
+{
+	return std::size_t(std::count_if(p, p + n, [](CharT c){ return is_code_point_start(c); }));
+}
+
+#ifdef __unix__
+
+/**
+ * Write all of `iov` to `fd`, resuming after partial writes.
+ * The iovec entries are modified.
+ */
+inline
+void writev_all(int fd, iovec* iov, std::size_t n)
+{
+	while(n)
+	{
+		auto written = ::writev(fd, iov, int(n));
+
+		if(written == -1)
+		{
+			if(errno == EINTR)
+				continue;
+			throw std::runtime_error(std::string("writev: ") + std::strerror(errno));
+		}
+
+		for(; n && std::size_t(written) >= iov->iov_len; ++iov, --n)
+			written -= ssize_t(iov->iov_len);
+
+		if(n)
+		{
+			iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+			iov->iov_len -= std::size_t(written);
+		}
+	}
+}
+
+#endif // __unix__
+
+} // namespace detail
+
+/**
+ * A rope is a balanced (AVL) binary tree whose leaves are immutable
+ * chunks of characters. Each node caches the length of its subtree
+ * so insert, erase, substr and concatenation are all O(log n).
+ *
+ * Nodes are never modified once built so copies share the whole tree
+ * and edits only rebuild the path from the root to the edited leaves.
+ *
+ * Because chunks are shared between copies the characters are read
+ * only: iterators and element access return const references.
+ *
+ * Every copy is therefore a persistent version. A copy (or snapshot())
+ * can be handed to another thread and read there while the original
+ * carries on being edited. Only the reference counts are shared and
+ * those are atomic. As with the standard containers, a single rope
+ * object must not be modified while another thread is using it.
+ */
 template<typename CharT>
 class basic_rope
 {
-	using impl_type = std::deque<CharT>;
+	struct node;
+	using node_ptr = std::shared_ptr<node const>;
+
+	static constexpr std::size_t uncounted = std::size_t(-1);
+
+	struct node
+	{
+		node_ptr left;   // nullptr for leaves
+		node_ptr right;  // nullptr for leaves
+		std::shared_ptr<CharT const> chunk; // leaves only
+		std::size_t length = 0;
+
+		// counted on demand so building over a memory map doesn't read it
+		mutable std::atomic<std::size_t> newlines{uncounted};
+		mutable std::atomic<std::size_t> code_points{uncounted};
+		unsigned height = 0;
+
+		bool is_leaf() const { return !left; }
+	};
 
 public:
-	using size_type = typename impl_type::size_type;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
 	using value_type = CharT;
 	using pointer = CharT*;
 	using const_pointer = CharT const*;
-	using reference = CharT&;
+	using reference = CharT const&;
 	using const_reference = CharT const&;
 
-	using iterator = typename impl_type::iterator;
-	using const_iterator = typename impl_type::const_iterator;
+	using traits_type = std::char_traits<CharT>;
+
+	class const_iterator;
+	using iterator = const_iterator;
+
+	//! A contiguous piece of the rope.
+	using chunk_type = range::basic_range<CharT const>;
+
+	class chunk_iterator;
+	class chunk_range;
 
 	static constexpr size_type npos = size_type(-1);
 
+	//! The largest leaf built by copying characters into the rope.
+	static constexpr size_type chunk_size = 1024;
+
+	//! The largest leaf viewing external (memory mapped) characters.
+	static constexpr size_type view_size = 64 * 1024;
+
 	basic_rope() = default;
 	basic_rope(basic_rope&&) = default;
 	basic_rope(basic_rope const&) = default;
 	basic_rope& operator=(basic_rope&&) = default;
 	basic_rope& operator=(basic_rope const&) = default;
 
-	// TODO: complete constructors
-	basic_rope(std::basic_string<CharT> const& s) noexcept: impl(s.begin(), s.end()) {}
-	basic_rope(size_type n, CharT c) noexcept: impl(n, c) {}
+	basic_rope(std::basic_string<CharT> const& s): basic_rope(s.data(), s.size()) {}
+	basic_rope(size_type n, CharT c): root(fill(n, c)) {}
 
-	basic_rope(basic_rope const& r, size_type pos): impl(r.begin() + pos, r.end()) {}
-	basic_rope(basic_rope const& r, size_type pos, size_type n)
-	{
-		if(pos > r.size())
-			throw std::out_of_range("bad index: " << to_string(pos) << " of " << to_string(impl.size()));
-		impl.assign(r.begin() + pos, r.begin() + pos + n);
-	}
+	basic_rope(basic_rope const& r, size_type pos): basic_rope(r.substr(pos)) {}
+	basic_rope(basic_rope const& r, size_type pos, size_type n): basic_rope(r.substr(pos, n)) {}
 
-	basic_rope(CharT const* s, size_type n): impl(s, s + n) {}
-	basic_rope(CharT const* s) noexcept: basic_rope(s, std::strlen(s)) {}
+	basic_rope(CharT const* s, size_type n): root(build(s, n)) {}
+	basic_rope(CharT const* s): basic_rope(s, zstring_utils::generic::strlen(s)) {}
 
 	template< class InputIt >
-	basic_rope(InputIt first, InputIt last): impl(first, last) {}
+	basic_rope(InputIt first, InputIt last): root(build(first, last)) {}
 	basic_rope(std::initializer_list<CharT> il): basic_rope(il.begin(), il.end()) {}
 
-	// end constructors
+	// append
 
 	template<typename Iter>
 	basic_rope<CharT>& append(Iter first, Iter last)
 	{
-		impl.insert(impl.begin(), first, last);
+		insert(end(), first, last);
 		return *this;
 	}
 
 	basic_rope<CharT>& append(basic_rope<CharT> const& r)
 	{
-		impl.insert(impl.end(), r.begin(), r.end());
+		root = join(root, r.root);
 		return *this;
 	}
 
-	basic_rope<CharT>& append(std::basic_string<CharT> const& r)
+	basic_rope<CharT>& append(std::basic_string<CharT> const& s)
 	{
-		impl.insert(impl.end(), r.begin(), r.end());
-		return *this;
+		return append(s.data(), s.size());
 	}
 
 	basic_rope<CharT>& append(CharT const* s)
 	{
-		while(*s)
-			impl.push_back(*s++);
-		return *this;
+		return append(s, zstring_utils::generic::strlen(s));
 	}
 
 	basic_rope<CharT>& append(CharT const* s, size_type n)
 	{
-		return append(s, s + n);
+		return insert(size(), s, n);
 	}
 
 	basic_rope<CharT>& append(std::initializer_list<CharT> il)
 	{
-		return append(il.begin(), il.end());
+		return append(il.begin(), il.size());
 	}
 
 	basic_rope<CharT>& append(size_type n, CharT c)
 	{
-		while(n--)
-			append(c);
-		return *this;
+		return insert(size(), n, c);
 	}
 
+	void push_back(CharT c) { append(&c, 1); }
+	void pop_back() { erase(size() - 1, 1); }
+
+	basic_rope<CharT>& operator+=(basic_rope<CharT> const& r) { return append(r); }
+	basic_rope<CharT>& operator+=(std::basic_string<CharT> const& s) { return append(s); }
+	basic_rope<CharT>& operator+=(CharT const* s) { return append(s); }
+	basic_rope<CharT>& operator+=(CharT c) { return append(&c, 1); }
+	basic_rope<CharT>& operator+=(std::initializer_list<CharT> il) { return append(il); }
+
+	// assign
+
 	template<typename Iter>
 	basic_rope<CharT>& assign(Iter first, Iter last)
 	{
-		impl.assign(first, last);
+		root = build(first, last);
 		return *this;
 	}
 
 	basic_rope<CharT>& assign(basic_rope<CharT>&& r)
 	{
-		impl.assign(std::move(r.impl));
+		root = std::move(r.root);
 		return *this;
 	}
 
 	basic_rope<CharT>& assign(basic_rope<CharT> const& r)
 	{
-		impl.assign(r.impl);
+		root = r.root;
 		return *this;
 	}
 
-	basic_rope<CharT>& assign(std::basic_string<CharT> const& r)
+	basic_rope<CharT>& assign(std::basic_string<CharT> const& s)
 	{
-		impl.assign(r.begin(), r.end());
-		return *this;
+		return assign(s.data(), s.size());
 	}
 
-	basic_rope<CharT>& assign(std::basic_string<CharT> const& r, size_type pos, size_type n = npos)
+	basic_rope<CharT>& assign(std::basic_string<CharT> const& s, size_type pos, size_type n = npos)
 	{
-		using std::to_string;
-
-		if(pos > impl.size())
-			throw std::out_of_range("bad index: " << to_string(pos) << " of " << to_string(impl.size()));
-
-		if(n == npos || !(pos + n < impl.size()))
-			n = impl.size() - pos;
-
-		impl.assign(r.begin() + pos, r.begin() + pos + n);
-		return *this;
+		check_index(pos, s.size());
+		return assign(s.data() + pos, std::min(n, s.size() - pos));
 	}
 
 	basic_rope<CharT>& assign(CharT const* s)
 	{
-		impl.assign(s, s + std::strlen(s));
-		return *this;
+		return assign(s, zstring_utils::generic::strlen(s));
 	}
 
 	basic_rope<CharT>& assign(CharT const* s, size_type n)
 	{
-		return assign(s, s + n);
+		root = build(s, n);
+		return *this;
 	}
 
 	basic_rope<CharT>& assign(std::initializer_list<CharT> il)
 	{
-		return assign(il.begin(), il.end());
+		return assign(il.begin(), il.size());
 	}
 
 	basic_rope<CharT>& assign(size_type n, CharT c)
 	{
-		impl.clear();
-		return append(n, c);
+		root = fill(n, c);
+		return *this;
+	}
+
+	// element access
+
+	const_reference at(size_type pos) const
+	{
+		if(!(pos < size()))
+			throw std::out_of_range("bad index: " + std::to_string(pos) + " of " + std::to_string(size()));
+		return (*this)[pos];
 	}
 
-	reference at(size_type pos) { return impl.at(pos); }
-	const_reference at(size_type pos) const { return impl.at(pos); }
+	const_reference operator[](size_type pos) const
+	{
+		size_type beg = 0;
+		auto leaf = locate(root.get(), pos, beg);
+		return leaf->chunk.get()[pos - beg];
+	}
 
-	reference back() { return impl.back(); }
-	const_reference back(size_type pos) const { return impl.back(); }
+	const_reference front() const { return (*this)[0]; }
+	const_reference back() const { return (*this)[size() - 1]; }
 
 	const_pointer c_str() const = delete; // non-contiguous
 	pointer data() = delete; // non-contiguous
 	const_pointer data() const = delete; // non-contiguous
 
-	std::basic_string<CharT> string() const { return {impl.begin(), impl.end()}; }
+	std::basic_string<CharT> string() const
+	{
+		std::basic_string<CharT> s;
+		s.reserve(size());
+		for_each_chunk([&](chunk_type c){ s.append(c.data(), c.size()); });
+		return s;
+	}
+
+	/**
+	 * Copy up to `n` characters starting at `pos` into `dest`.
+	 * @return The number of characters copied.
+	 */
+	size_type copy(CharT* dest, size_type n, size_type pos = 0) const
+	{
+		check_index(pos, size());
+		auto d = dest;
+		for(auto c: chunks(pos, n))
+			d = std::copy(c.begin(), c.end(), d);
+		return size_type(d - dest);
+	}
+
+	// chunks
+
+	/**
+	 * Call `func(chunk_type)` for each contiguous piece of the rope in
+	 * order. This is much faster than iterating character by character.
+	 */
+	template<typename Func>
+	void for_each_chunk(Func func) const
+	{
+		for_each_chunk(root.get(), [&](CharT const* p, size_type n){ func(chunk_type(p, n)); });
+	}
+
+	/**
+	 * The contiguous pieces making up the characters
+	 * [pos, pos + n) of the rope, in order.
+	 *
+	 * for(auto chunk: r.chunks())
+	 *     os.write(chunk.data(), chunk.size());
+	 */
+	chunk_range chunks(size_type pos = 0, size_type n = npos) const
+	{
+		check_index(pos, size());
+		return {root.get(), pos, pos + std::min(n, size() - pos)};
+	}
+
+	// lines
+
+	/**
+	 * Lines are separated by '\n' so there is always one
+	 * more line than there are newlines.
+	 */
+	size_type line_count() const { return (root ? newlines_of(root.get()) : 0) + 1; }
+
+	//! Code points, counting UTF-8 (or UTF-16) sequences as one.
+	size_type code_points() const { return root ? code_points_of(root.get()) : 0; }
+
+	//! The (zero based) line containing offset `pos`, in O(log n).
+	size_type offset_to_line(size_type pos) const
+	{
+		check_index(pos, size());
+		return count_before(pos, newlines_of, detail::count_newlines<CharT>);
+	}
+
+	//! The offset of the start of (zero based) line `line`, in O(log n).
+	size_type line_to_offset(size_type line) const
+	{
+		if(!(line < line_count()))
+			throw std::out_of_range("bad line: " + std::to_string(line) + " of " + std::to_string(line_count()));
 
-	size_type capacity() const { return impl.capacity(); }
+		if(!line)
+			return 0;
 
-	void clear() { impl.clear(); }
+		return find_nth(line - 1, newlines_of,
+			[](CharT c){ return c == CharT('\n'); }) + 1;
+	}
+
+	struct line_column
+	{
+		size_type line;
+		size_type column; // in code points
+	};
+
+	line_column offset_to_line_column(size_type pos) const
+	{
+		auto line = offset_to_line(pos);
+		return {line, code_points_before(pos) - code_points_before(line_to_offset(line))};
+	}
+
+	/**
+	 * The offset of `column` code points along `line`. Columns past the
+	 * end of the line are clamped to the line's end.
+	 */
+	size_type line_column_to_offset(size_type line, size_type column) const
+	{
+		auto beg = line_to_offset(line);
+		auto end = line + 1 < line_count() ? line_to_offset(line + 1) - 1 : size();
+
+		auto n = code_points_before(beg) + column;
+
+		if(!(n < code_points()))
+			return end;
+
+		return std::min(end, find_nth(n, code_points_of,
+			[](CharT c){ return detail::is_code_point_start(c); }));
+	}
+
+	/**
+	 * The text of (zero based) line `line` without its '\n', in O(log n).
+	 *
+	 * for(std::size_t n = 0; n < r.line_count(); ++n)
+	 *     process(r.line(n));
+	 */
+	basic_rope<CharT> line(size_type line) const
+	{
+		auto beg = line_to_offset(line);
+		auto end = line + 1 < line_count() ? line_to_offset(line + 1) - 1 : size();
+		return substr(beg, end - beg);
+	}
+
+#ifdef __unix__
+
+	// files
+
+	/**
+	 * A rope whose leaves refer directly to a read-only memory map of
+	 * `filename`. Nothing is copied (or even read) up front and only the
+	 * regions that are later edited are copied into heap chunks. The
+	 * mapping lives until the last rope version using it is gone.
+	 *
+	 * The file must not be truncated while it is mapped. save() is
+	 * safe because it replaces the file rather than rewriting it.
+	 */
+	static basic_rope<CharT> map_file(std::string const& filename)
+	{
+		auto mapping = std::make_shared<string_utils::mapped_file>(filename);
+
+		if(mapping->size() % sizeof(CharT))
+			throw std::runtime_error(filename + ": size is not a whole number of characters");
+
+		std::shared_ptr<CharT const> base(mapping, reinterpret_cast<CharT const*>(mapping->data()));
+		return basic_rope<CharT>(view(base, mapping->size() / sizeof(CharT)));
+	}
+
+	/**
+	 * Write the rope's chunks straight to `fd` using writev().
+	 */
+	void write_to(int fd) const
+	{
+#ifdef IOV_MAX
+		constexpr std::size_t iov_max = IOV_MAX;
+#else
+		constexpr std::size_t iov_max = 1024;
+#endif
+		std::vector<iovec> iov;
+		iov.reserve(iov_max);
+
+		for(auto chunk: chunks())
+		{
+			iov.push_back({const_cast<CharT*>(chunk.data()), chunk.size() * sizeof(CharT)});
+
+			if(iov.size() == iov_max)
+			{
+				detail::writev_all(fd, iov.data(), iov.size());
+				iov.clear();
+			}
+		}
+
+		detail::writev_all(fd, iov.data(), iov.size());
+	}
+
+	/**
+	 * Save the rope to `filename`. The content is written to a temporary
+	 * file that then replaces `filename`, so it is safe to save a rope
+	 * over the file it was mapped from.
+	 */
+	void save(std::string const& filename) const
+	{
+		auto tmpname = filename + ".hol-save~";
+
+		struct stat st;
+		auto mode = ::stat(filename.c_str(), &st) == -1 ? mode_t(0666) : (st.st_mode & 07777);
+
+		auto fd = ::open(tmpname.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, mode);
+
+		if(fd == -1)
+			throw std::runtime_error(tmpname + ": " + std::strerror(errno));
+
+		try
+		{
+			write_to(fd);
+
+			if(::close(fd) == -1)
+				throw std::runtime_error(tmpname + ": " + std::strerror(errno));
+
+			fd = -1;
+
+			if(::rename(tmpname.c_str(), filename.c_str()) == -1)
+				throw std::runtime_error(filename + ": " + std::strerror(errno));
+		}
+		catch(...)
+		{
+			if(fd != -1)
+				::close(fd);
+			::unlink(tmpname.c_str());
+			throw;
+		}
+	}
+
+#endif // __unix__
+
+	// search
+
+	size_type find(CharT c, size_type pos = 0) const
+	{
+		if(!(pos < size()))
+			return npos;
+
+		for(auto chunk: chunks(pos))
+		{
+			if(auto found = traits_type::find(chunk.data(), chunk.size(), c))
+				return pos + size_type(found - chunk.data());
+			pos += chunk.size();
+		}
+
+		return npos;
+	}
+
+	size_type find(CharT const* s, size_type pos, size_type n) const
+	{
+		if(!n)
+			return pos <= size() ? pos : npos;
+
+		for(; n <= size() && pos <= size() - n; ++pos)
+		{
+			pos = find(s[0], pos);
+
+			if(pos == npos || n > size() - pos)
+				return npos;
+
+			if(!compare_at(pos, s, n))
+				return pos;
+		}
+
+		return npos;
+	}
+
+	size_type find(CharT const* s, size_type pos = 0) const
+	{
+		return find(s, pos, zstring_utils::generic::strlen(s));
+	}
+
+	size_type find(std::basic_string<CharT> const& s, size_type pos = 0) const
+	{
+		return find(s.data(), pos, s.size());
+	}
+
+	size_type find(basic_rope<CharT> const& r, size_type pos = 0) const
+	{
+		return find(r.string(), pos);
+	}
+
+	bool empty() const { return !root; }
+	size_type size() const { return root ? root->length : 0; }
+	size_type length() const { return size(); }
+
+	void clear() { root.reset(); }
+	void swap(basic_rope<CharT>& r) noexcept { root.swap(r.root); }
+
+	/**
+	 * An immutable version of the current content in O(1). Later edits
+	 * to this rope leave the snapshot unchanged.
+	 */
+	basic_rope<CharT> snapshot() const { return *this; }
+
+	/**
+	 * @return true if both ropes are the same version (share the same tree).
+	 * Same version implies equal content in O(1).
+	 */
+	bool same_version(basic_rope<CharT> const& r) const { return root == r.root; }
+
+	// compare
 
 	int compare(basic_rope<CharT> const& r) const
 	{
-		return std::lexicographical_compare(impl.begin(), impl.end(), r.impl.begin(), r.impl.end());
+		if(same_version(r))
+			return 0;
+
+		auto lhs = chunks();
+		auto rhs = r.chunks();
+
+		auto i = lhs.begin();
+		auto j = rhs.begin();
+
+		chunk_type a, b;
+
+		for(;;)
+		{
+			if(a.empty() && i != lhs.end())
+				a = *i++;
+
+			if(b.empty() && j != rhs.end())
+				b = *j++;
+
+			if(a.empty() || b.empty())
+				break;
+
+			auto n = std::min(a.size(), b.size());
+
+			if(auto cmp = traits_type::compare(a.data(), b.data(), n))
+				return cmp;
+
+			a = chunk_type(a.data() + n, a.size() - n);
+			b = chunk_type(b.data() + n, b.size() - n);
+		}
+
+		return a.empty() ? (b.empty() ? 0 : -1) : 1;
 	}
 
 	int compare(std::basic_string<CharT> const& s) const
 	{
-		return std::lexicographical_compare(impl.begin(), impl.end(), s.begin(), s.end());
+		return compare(s.data(), s.size());
 	}
 
 	int compare(CharT const* s) const
 	{
-		return std::lexicographical_compare(impl.begin(), impl.end(), s, s + std::strlen(s));
+		return compare(s, zstring_utils::generic::strlen(s));
+	}
+
+	int compare(CharT const* s, size_type n) const
+	{
+		auto cmp = compare_at(0, s, std::min(n, size()));
+		return cmp ? cmp : size() < n ? -1 : size() > n ? 1 : 0;
 	}
 
 	int compare(size_type pos, size_type n, const basic_rope& r) const
 	{
-		return basic_rope<CharT>(*this, pos, n).compare(r);
+		return substr(pos, n).compare(r);
 	}
 
 	basic_rope<CharT> substr(size_type pos = 0, size_type count = npos) const
 	{
-		return {std::next(begin(), pos), std::next(begin(), pos + count)};
+		check_index(pos, size());
+		return basic_rope<CharT>(split(split(root, pos).second, count).first);
 	}
 
+	// insert
+
 	basic_rope<CharT>& insert(size_type pos, size_type n, CharT ch)
 	{
-		impl.insert(std::next(begin(), pos), n, ch);
+		check_index(pos, size());
+
+		if(n > chunk_size)
+			insert_tree(pos, fill(n, ch));
+		else
+			root = insert_small(root, pos, repeat_iterator{ch}, n);
+
 		return *this;
 	}
 
 	basic_rope<CharT>& insert(size_type pos, CharT const* s)
 	{
-		using zstring_utils::generic::strlen;
-		impl.insert(std::next(begin(), pos), s, s + strlen(s));
-		return *this;
+		return insert(pos, s, zstring_utils::generic::strlen(s));
 	}
 
 	basic_rope<CharT>& insert(size_type pos, CharT const* s, size_type n)
 	{
-		using zstring_utils::generic::strnlen;
-		impl.insert(std::next(begin(), pos), s, s + strnlen(s, n));
+		check_index(pos, size());
+
+		if(n > chunk_size)
+			insert_tree(pos, build(s, n));
+		else
+			root = insert_small(root, pos, s, n);
+
 		return *this;
 	}
 
+	basic_rope<CharT>& insert(size_type pos, std::basic_string<CharT> const& s)
+	{
+		return insert(pos, s.data(), s.size());
+	}
+
 	basic_rope<CharT>& insert(size_type pos, basic_rope<CharT> const& r)
 	{
-		impl.insert(std::next(begin(), pos), std::begin(r), std::end(r));
+		check_index(pos, size());
+		insert_tree(pos, r.root);
 		return *this;
 	}
 
 	basic_rope<CharT>& insert(size_type pos, basic_rope<CharT> const& r,
 		size_type r_pos, size_type n = npos)
 	{
-		HOL_ASSERT_MSG(r_pos < r.size(), "out of rope bounds: " << r_pos << " > " << r.size());
+		return insert(pos, r.substr(r_pos, n));
+	}
+
+	iterator insert(const_iterator pos, CharT ch)
+	{
+		insert(pos.pos, 1, ch);
+		return {root.get(), pos.pos};
+	}
 
-		auto r_size = r.size();
+	iterator insert(const_iterator pos, size_type count, CharT ch)
+	{
+		insert(pos.pos, count, ch);
+		return {root.get(), pos.pos};
+	}
 
-		if(n == npos)
-			n = r_size - r_pos;
+	template< class InputIt >
+	iterator insert(const_iterator pos, InputIt first, InputIt last)
+	{
+		insert_iters(pos.pos, first, last,
+			typename std::iterator_traits<InputIt>::iterator_category());
+		return {root.get(), pos.pos};
+	}
 
-		if(r_pos + n > r.size() - 1)
-			n = r_size - r_pos;
+	iterator insert(const_iterator pos, std::initializer_list<CharT> ilist)
+	{
+		insert(pos.pos, ilist.begin(), ilist.size());
+		return {root.get(), pos.pos};
+	}
 
-		auto r_beg = std::next(std::begin(r), r_pos);
-		auto r_end = std::next(std::begin(r), r_pos + n);
+	template < class T, typename = std::enable_if_t<!std::is_arithmetic<T>::value
+		&& !std::is_convertible<T const&, CharT const*>::value> >
+	basic_rope<CharT>& insert(size_type pos, const T& t, size_type index_str, size_type count = npos)
+	{
+		auto t_size = size_type(std::distance(std::begin(t), std::end(t)));
+		check_index(index_str, t_size);
+		count = std::min(count, t_size - index_str);
 
-		impl.insert(std::next(begin(), pos), r_beg, r_end);
+		auto first = std::next(std::begin(t), index_str);
+		insert({root.get(), pos}, first, std::next(first, count));
 		return *this;
 	}
 
-	iterator insert(iterator pos, CharT ch)
+	// erase
+
+	basic_rope<CharT>& erase(size_type pos = 0, size_type n = npos)
 	{
+		check_index(pos, size());
+		auto lhs = split(root, pos);
+		root = join(lhs.first, split(lhs.second, n).second);
 		return *this;
 	}
 
-	iterator insert(const_iterator pos, CharT ch)
+	iterator erase(const_iterator pos)
 	{
-		return *this;
+		erase(pos.pos, 1);
+		return {root.get(), pos.pos};
 	}
 
-	void insert(iterator pos, size_type count, CharT ch)
+	iterator erase(const_iterator first, const_iterator last)
 	{
-//		return *this;
+		erase(first.pos, last.pos - first.pos);
+		return {root.get(), first.pos};
 	}
 
-	iterator insert(const_iterator pos, size_type count, CharT ch)
+	// iteration
+
+	const_iterator begin() const { return {root.get(), 0}; }
+	const_iterator end() const { return {root.get(), size()}; }
+
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	friend basic_rope<CharT> operator+(basic_rope<CharT> const& lhs, basic_rope<CharT> const& rhs)
 	{
-		return *this;
+		return basic_rope<CharT>(join(lhs.root, rhs.root));
 	}
 
-	template< class InputIt >
-	void insert(iterator pos, InputIt first, InputIt last)
+	friend
+	std::basic_ostream<CharT>& operator<<(std::basic_ostream<CharT>& os, basic_rope<CharT> const& r)
 	{
-//		return *this;
+		r.for_each_chunk([&](chunk_type c){ os.write(c.data(), std::streamsize(c.size())); });
+		return os;
 	}
 
-	template< class InputIt >
-	iterator insert(const_iterator pos, InputIt first, InputIt last)
+	bool operator==(basic_rope<CharT> const& other) const { return compare(other) == 0; }
+	bool operator!=(basic_rope<CharT> const& other) const { return !(*this == other); }
+	bool operator<(basic_rope<CharT> const& other) const { return compare(other) < 0; }
+
+	/**
+	 * Random access iterator over the (immutable) characters of a rope.
+	 * The leaf holding the current position is cached so sequential
+	 * access only walks the tree once per leaf.
+	 *
+	 * Like other container iterators it is invalidated by any
+	 * modification of the rope.
+	 */
+	class const_iterator
 	{
-		return *this;
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = CharT;
+		using difference_type = std::ptrdiff_t;
+		using pointer = CharT const*;
+		using reference = CharT const&;
+
+		const_iterator() = default;
+
+		reference operator*() const
+		{
+			if(pos < leaf_beg || !(pos < leaf_end))
+				seek();
+			return leaf[pos - leaf_beg];
+		}
+
+		pointer operator->() const { return &**this; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+		const_iterator& operator++() { ++pos; return *this; }
+		const_iterator& operator--() { --pos; return *this; }
+		const_iterator operator++(int) { auto i = *this; ++pos; return i; }
+		const_iterator operator--(int) { auto i = *this; --pos; return i; }
+
+		const_iterator& operator+=(difference_type n) { pos += n; return *this; }
+		const_iterator& operator-=(difference_type n) { pos -= n; return *this; }
+
+		friend const_iterator operator+(const_iterator i, difference_type n) { return i += n; }
+		friend const_iterator operator+(difference_type n, const_iterator i) { return i += n; }
+		friend const_iterator operator-(const_iterator i, difference_type n) { return i -= n; }
+
+		friend difference_type operator-(const_iterator const& a, const_iterator const& b)
+			{ return difference_type(a.pos) - difference_type(b.pos); }
+
+		friend bool operator==(const_iterator const& a, const_iterator const& b) { return a.pos == b.pos; }
+		friend bool operator!=(const_iterator const& a, const_iterator const& b) { return a.pos != b.pos; }
+		friend bool operator<(const_iterator const& a, const_iterator const& b) { return a.pos < b.pos; }
+		friend bool operator>(const_iterator const& a, const_iterator const& b) { return a.pos > b.pos; }
+		friend bool operator<=(const_iterator const& a, const_iterator const& b) { return a.pos <= b.pos; }
+		friend bool operator>=(const_iterator const& a, const_iterator const& b) { return a.pos >= b.pos; }
+
+	private:
+		friend class basic_rope<CharT>;
+
+		const_iterator(node const* root, size_type pos): root(root), pos(pos) {}
+
+		void seek() const
+		{
+			auto n = locate(root, pos, leaf_beg);
+			leaf = n->chunk.get();
+			leaf_end = leaf_beg + n->length;
+		}
+
+		node const* root = nullptr;
+		size_type pos = 0;
+
+		mutable CharT const* leaf = nullptr;
+		mutable size_type leaf_beg = 0;
+		mutable size_type leaf_end = 0;
+	};
+
+	/**
+	 * Forward iterator yielding successive chunk_type pieces of a rope.
+	 */
+	class chunk_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = chunk_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = chunk_type const*;
+		using reference = chunk_type const&;
+
+		chunk_iterator() = default;
+
+		reference operator*() const { return chunk; }
+		pointer operator->() const { return &chunk; }
+
+		chunk_iterator& operator++()
+		{
+			pos += chunk.size();
+			seek();
+			return *this;
+		}
+
+		chunk_iterator operator++(int) { auto i = *this; ++(*this); return i; }
+
+		friend bool operator==(chunk_iterator const& a, chunk_iterator const& b) { return a.pos == b.pos; }
+		friend bool operator!=(chunk_iterator const& a, chunk_iterator const& b) { return a.pos != b.pos; }
+
+	private:
+		friend class basic_rope<CharT>;
+
+		chunk_iterator(node const* root, size_type pos, size_type last)
+		: root(root), pos(pos), last(last) { seek(); }
+
+		void seek()
+		{
+			if(!(pos < last))
+			{
+				chunk = {};
+				return;
+			}
+
+			size_type beg;
+			auto leaf = locate(root, pos, beg);
+			chunk = chunk_type(leaf->chunk.get() + (pos - beg), std::min(beg + leaf->length, last) - pos);
+		}
+
+		node const* root = nullptr;
+		size_type pos = 0;
+		size_type last = 0;
+		chunk_type chunk;
+	};
+
+	class chunk_range
+	{
+	public:
+		chunk_iterator begin() const { return {root, first, last}; }
+		chunk_iterator end() const { return {root, last, last}; }
+
+	private:
+		friend class basic_rope<CharT>;
+
+		chunk_range(node const* root, size_type first, size_type last)
+		: root(root), first(first), last(last) {}
+
+		node const* root;
+		size_type first;
+		size_type last;
+	};
+
+private:
+	explicit basic_rope(node_ptr root): root(std::move(root)) {}
+
+	//! Endless input of the same character, for building filled leaves.
+	struct repeat_iterator
+	{
+		CharT c;
+		CharT operator*() const { return c; }
+		repeat_iterator& operator++() { return *this; }
+	};
+
+	static void check_index(size_type pos, size_type size)
+	{
+		if(pos > size)
+			throw std::out_of_range("bad index: " + std::to_string(pos) + " of " + std::to_string(size));
 	}
 
-	iterator insert(const_iterator pos, std::initializer_list<CharT> ilist)
+	static size_type newlines_of(node const* t)
 	{
-		return *this;
+		auto n = t->newlines.load(std::memory_order_relaxed);
+
+		if(n == uncounted)
+		{
+			n = t->is_leaf() ? detail::count_newlines(t->chunk.get(), t->length)
+				: newlines_of(t->left.get()) + newlines_of(t->right.get());
+			t->newlines.store(n, std::memory_order_relaxed);
+		}
+
+		return n;
 	}
 
-	template < class T >
-	basic_rope<CharT>& insert(size_type pos, const T& t, size_type index_str, size_type count = npos)
+	static size_type code_points_of(node const* t)
 	{
-		return *this;
+		auto n = t->code_points.load(std::memory_order_relaxed);
+
+		if(n == uncounted)
+		{
+			n = t->is_leaf() ? detail::count_code_points(t->chunk.get(), t->length)
+				: code_points_of(t->left.get()) + code_points_of(t->right.get());
+			t->code_points.store(n, std::memory_order_relaxed);
+		}
+
+		return n;
 	}
 
+	size_type code_points_before(size_type pos) const
+	{
+		return count_before(pos, code_points_of, detail::count_code_points<CharT>);
+	}
+
+	//! Sum a node statistic over [0, pos).
+	template<typename Stat, typename Count>
+	size_type count_before(size_type pos, Stat stat, Count count) const
+	{
+		size_type n = 0;
+
+		for(auto t = root.get(); t && pos;)
+		{
+			if(t->is_leaf())
+				return n + count(t->chunk.get(), pos);
+
+			if(pos < t->left->length)
+				t = t->left.get();
+			else
+			{
+				n += stat(t->left.get());
+				pos -= t->left->length;
+				t = t->right.get();
+			}
+		}
+
+		return n;
+	}
+
+	//! The offset of the (zero based) nth character that matches `is`.
+	template<typename Stat, typename Pred>
+	size_type find_nth(size_type nth, Stat stat, Pred is) const
+	{
+		HOL_ASSERT_MSG(root && nth < stat(root.get()), "out of rope bounds: " << nth);
+
+		size_type pos = 0;
+		auto t = root.get();
+
+		while(!t->is_leaf())
+		{
+			if(nth < stat(t->left.get()))
+				t = t->left.get();
+			else
+			{
+				nth -= stat(t->left.get());
+				pos += t->left->length;
+				t = t->right.get();
+			}
+		}
+
+		for(auto p = t->chunk.get();; ++p)
+			if(is(*p) && !nth--)
+				return pos + size_type(p - t->chunk.get());
+	}
 
-	size_type size() const { return impl.size(); }
+	//! Compare [pos, pos + n) with the `n` characters at `s`.
+	int compare_at(size_type pos, CharT const* s, size_type n) const
+	{
+		for(auto c: chunks(pos, n))
+		{
+			if(auto cmp = traits_type::compare(c.data(), s, c.size()))
+				return cmp;
+			s += c.size();
+		}
+		return 0;
+	}
 
-	auto begin() { return impl.begin(); }
-	auto begin() const { return impl.begin(); }
-	auto end() { return impl.end(); }
-	auto end() const { return impl.end(); }
+	template<typename Iter>
+	void insert_iters(size_type pos, Iter first, Iter last, std::forward_iterator_tag)
+	{
+		check_index(pos, size());
 
-	auto cbegin() const { return impl.cbegin(); }
-	auto cend() const { return impl.cend(); }
+		auto n = size_type(std::distance(first, last));
 
-	//	template<typename CharT>
-	//	basic_rope<CharT> subvec(basic_rope<CharT> const& v, size_type pos, size_type n = size_type(-1))
-	//	{
-	//		if(n == size_type(-1))
-	//			n = v.size() - pos;
-	//		return {v.begin() + pos, v.begin() + pos + n};
-	//	}
-	//
+		if(n > chunk_size)
+			insert_tree(pos, build_n(first, n));
+		else
+			root = insert_small(root, pos, first, n);
+	}
 
-	friend
-	std::basic_ostream<CharT>& operator<<(std::basic_ostream<CharT>& os, basic_rope<CharT> const& r)
+	template<typename Iter>
+	void insert_iters(size_type pos, Iter first, Iter last, std::input_iterator_tag)
 	{
-		for(auto c: r)
-			os.put(c);
-		return os;
+		std::basic_string<CharT> s(first, last);
+		insert(pos, s.data(), s.size());
 	}
 
-	bool operator==(basic_rope<CharT> const& other) const { return compare(other) == 0; }
-	bool operator!=(basic_rope<CharT> const& other) const { return !(*this == other); }
+	void insert_tree(size_type pos, node_ptr const& t)
+	{
+		auto parts = split(root, pos);
+		root = join(join(parts.first, t), parts.second);
+	}
+
+	//=============================================================
+	//== Tree algorithms
+	//=============================================================
+
+	static unsigned height(node_ptr const& t) { return t ? t->height : 0; }
+
+	template<typename Func>
+	static void for_each_chunk(node const* t, Func&& func)
+	{
+		while(t)
+		{
+			if(t->is_leaf())
+			{
+				func(t->chunk.get(), t->length);
+				return;
+			}
+			for_each_chunk(t->left.get(), func);
+			t = t->right.get();
+		}
+	}
+
+	//! Find the leaf containing `pos` and the offset `beg` where that leaf starts.
+	static node const* locate(node const* t, size_type pos, size_type& beg)
+	{
+		HOL_ASSERT_MSG(t && pos < t->length, "out of rope bounds: " << pos);
+
+		beg = 0;
+		while(!t->is_leaf())
+		{
+			if(pos < t->left->length)
+				t = t->left.get();
+			else
+			{
+				pos -= t->left->length;
+				beg += t->left->length;
+				t = t->right.get();
+			}
+		}
+		return t;
+	}
+
+	static node_ptr make_leaf(std::shared_ptr<CharT const> chunk, size_type n)
+	{
+		if(!n)
+			return {};
+
+		auto leaf = std::make_shared<node>();
+		leaf->length = n;
+		leaf->chunk = std::move(chunk);
+		return leaf;
+	}
+
+	static std::shared_ptr<CharT> make_chunk(size_type n)
+	{
+		return std::shared_ptr<CharT>(new CharT[n], std::default_delete<CharT[]>());
+	}
+
+	template<typename Iter>
+	static node_ptr copy_leaf(Iter& first, size_type n)
+	{
+		if(!n)
+			return {};
+
+		auto chunk = make_chunk(n);
+		for(auto p = chunk.get(); p != chunk.get() + n; ++p, ++first)
+			*p = *first;
+
+		return make_leaf(std::move(chunk), n);
+	}
+
+	//! A leaf viewing part of another leaf's chunk, no characters are copied.
+	static node_ptr slice(node_ptr const& leaf, size_type pos, size_type n)
+	{
+		if(pos == 0 && n == leaf->length)
+			return leaf;
+		return make_leaf(std::shared_ptr<CharT const>(leaf->chunk, leaf->chunk.get() + pos), n);
+	}
+
+	static node_ptr make_node(node_ptr l, node_ptr r)
+	{
+		auto t = std::make_shared<node>();
+		t->length = l->length + r->length;
+		t->height = std::max(l->height, r->height) + 1;
+		t->left = std::move(l);
+		t->right = std::move(r);
+		return t;
+	}
+
+	//! Build a balanced tree from `n` characters.
+	template<typename Iter>
+	static node_ptr build_n(Iter& first, size_type n)
+	{
+		auto leaves = (n + chunk_size - 1) / chunk_size;
+
+		if(leaves < 2)
+			return copy_leaf(first, n);
+
+		auto left_n = (leaves / 2) * chunk_size;
+		auto l = build_n(first, left_n);
+		auto r = build_n(first, n - left_n);
+		return make_node(std::move(l), std::move(r));
+	}
+
+	static node_ptr build(CharT const* s, size_type n)
+	{
+		return build_n(s, n);
+	}
+
+	template<typename Iter>
+	static node_ptr build(Iter first, Iter last)
+	{
+		return build(first, last, typename std::iterator_traits<Iter>::iterator_category());
+	}
+
+	template<typename Iter>
+	static node_ptr build(Iter first, Iter last, std::forward_iterator_tag)
+	{
+		return build_n(first, size_type(std::distance(first, last)));
+	}
+
+	template<typename Iter>
+	static node_ptr build(Iter first, Iter last, std::input_iterator_tag)
+	{
+		std::basic_string<CharT> s(first, last);
+		return build(s.data(), s.size());
+	}
+
+	//! A balanced tree of leaves viewing (not copying) the `n` characters at `base`.
+	static node_ptr view(std::shared_ptr<CharT const> const& base, size_type n)
+	{
+		auto leaves = (n + view_size - 1) / view_size;
+
+		if(leaves < 2)
+			return make_leaf(base, n);
+
+		auto left_n = (leaves / 2) * view_size;
+		return make_node(view(base, left_n),
+			view(std::shared_ptr<CharT const>(base, base.get() + left_n), n - left_n));
+	}
+
+	//! Every leaf shares the same chunk of repeated characters.
+	static node_ptr fill(size_type n, CharT c)
+	{
+		repeat_iterator first{c};
+		auto chunk = copy_leaf(first, std::min(n, chunk_size));
+		return fill(n, chunk);
+	}
+
+	static node_ptr fill(size_type n, node_ptr const& chunk)
+	{
+		auto leaves = (n + chunk_size - 1) / chunk_size;
+
+		if(leaves < 2)
+			return n ? slice(chunk, 0, n) : node_ptr();
+
+		auto left_n = (leaves / 2) * chunk_size;
+		return make_node(fill(left_n, chunk), fill(n - left_n, chunk));
+	}
+
+	static node_ptr merge_leaves(node_ptr const& l, node_ptr const& r)
+	{
+		auto chunk = make_chunk(l->length + r->length);
+		std::copy_n(l->chunk.get(), l->length, chunk.get());
+		std::copy_n(r->chunk.get(), r->length, chunk.get() + l->length);
+		return make_leaf(std::move(chunk), l->length + r->length);
+	}
+
+	//! Make a node from subtrees whose heights differ by no more than 2.
+	static node_ptr balance(node_ptr const& l, node_ptr const& r)
+	{
+		if(height(r) > height(l) + 1)
+		{
+			if(height(r->left) > height(r->right))
+				return make_node(make_node(l, r->left->left), make_node(r->left->right, r->right));
+			return make_node(make_node(l, r->left), r->right);
+		}
+
+		if(height(l) > height(r) + 1)
+		{
+			if(height(l->right) > height(l->left))
+				return make_node(make_node(l->left, l->right->left), make_node(l->right->right, r));
+			return make_node(l->left, make_node(l->right, r));
+		}
+
+		return make_node(l, r);
+	}
+
+	static node_ptr join_right(node_ptr const& l, node_ptr const& r)
+	{
+		auto const& c = l->right;
+		auto t = c->height <= r->height + 1 ? join(c, r) : join_right(c, r);
+		return balance(l->left, t);
+	}
+
+	static node_ptr join_left(node_ptr const& l, node_ptr const& r)
+	{
+		auto const& c = r->left;
+		auto t = c->height <= l->height + 1 ? join(l, c) : join_left(l, c);
+		return balance(t, r->right);
+	}
+
+	//! Concatenate two trees in O(|height(l) - height(r)|).
+	static node_ptr join(node_ptr const& l, node_ptr const& r)
+	{
+		if(!l)
+			return r;
+
+		if(!r)
+			return l;
+
+		if(l->is_leaf() && r->is_leaf() && l->length + r->length <= chunk_size)
+			return merge_leaves(l, r);
+
+		if(l->height > r->height + 1)
+			return join_right(l, r);
+
+		if(r->height > l->height + 1)
+			return join_left(l, r);
+
+		return make_node(l, r);
+	}
+
+	//! Split a tree into [0, pos) and [pos, length) in O(log n).
+	static std::pair<node_ptr, node_ptr> split(node_ptr const& t, size_type pos)
+	{
+		if(!t || pos >= t->length)
+			return {t, nullptr};
+
+		if(pos == 0)
+			return {nullptr, t};
+
+		if(t->is_leaf())
+			return {slice(t, 0, pos), slice(t, pos, t->length - pos)};
+
+		if(pos < t->left->length)
+		{
+			auto parts = split(t->left, pos);
+			return {parts.first, join(parts.second, t->right)};
+		}
+
+		auto parts = split(t->right, pos - t->left->length);
+		return {join(t->left, parts.first), parts.second};
+	}
+
+	/**
+	 * Insert up to chunk_size characters by rebuilding the leaf at `pos`
+	 * in place when they fit. That keeps typing (and push_back) from
+	 * fragmenting the tree into tiny leaves.
+	 */
+	template<typename Iter>
+	static node_ptr insert_small(node_ptr const& t, size_type pos, Iter first, size_type n)
+	{
+		if(!n)
+			return t;
+
+		if(!t)
+			return copy_leaf(first, n);
+
+		if(t->is_leaf())
+		{
+			if(t->length + n > chunk_size)
+				return join(join(slice(t, 0, pos), copy_leaf(first, n)), slice(t, pos, t->length - pos));
+
+			auto chunk = make_chunk(t->length + n);
+			auto p = std::copy_n(t->chunk.get(), pos, chunk.get());
+			for(auto e = p + n; p != e; ++p, ++first)
+				*p = *first;
+			std::copy(t->chunk.get() + pos, t->chunk.get() + t->length, p);
+
+			return make_leaf(std::move(chunk), t->length + n);
+		}
+
+		if(pos <= t->left->length)
+			return join(insert_small(t->left, pos, first, n), t->right);
+
+		return join(t->left, insert_small(t->right, pos - t->left->length, first, n));
+	}
+
+	node_ptr root;
+};
+
+template<typename CharT>
+constexpr typename basic_rope<CharT>::size_type basic_rope<CharT>::npos;
+
+template<typename CharT>
+constexpr typename basic_rope<CharT>::size_type basic_rope<CharT>::chunk_size;
+
+template<typename CharT>
+constexpr typename basic_rope<CharT>::size_type basic_rope<CharT>::view_size;
+
+/**
+ * Undo/redo history of rope versions. Versions share their unchanged
+ * chunks so recording an undo point is O(1) whatever the size of the
+ * text.
+ *
+ * Usage:
+ *
+ *	hol::rope_history history{text};
+ *
+ *	auto r = history.current();
+ *	r.insert(pos, "typed");
+ *	history.commit(r);
+ *
+ *	history.undo(); // history.current() is the original text again
+ */
+template<typename CharT>
+class basic_rope_history
+{
+public:
+	using rope_type = basic_rope<CharT>;
+	using size_type = typename rope_type::size_type;
+
+	/**
+	 * @param initial The starting version.
+	 * @param max_undo The number of undo points kept before the
+	 * oldest versions are forgotten.
+	 */
+	explicit basic_rope_history(rope_type initial = {}, size_type max_undo = rope_type::npos)
+	: version(std::move(initial)), max_undo(max_undo) {}
+
+	rope_type const& current() const { return version; }
+
+	//! Make `r` the current version, recording an undo point.
+	void commit(rope_type r)
+	{
+		if(!max_undo)
+			undo_stack.clear();
+		else
+		{
+			if(undo_stack.size() == max_undo)
+				undo_stack.pop_front();
+			undo_stack.push_back(std::move(version));
+		}
+
+		redo_stack.clear();
+		version = std::move(r);
+	}
+
+	bool undo()
+	{
+		if(undo_stack.empty())
+			return false;
+
+		redo_stack.push_back(std::move(version));
+		version = std::move(undo_stack.back());
+		undo_stack.pop_back();
+		return true;
+	}
+
+	bool redo()
+	{
+		if(redo_stack.empty())
+			return false;
+
+		undo_stack.push_back(std::move(version));
+		version = std::move(redo_stack.back());
+		redo_stack.pop_back();
+		return true;
+	}
+
+	bool can_undo() const { return !undo_stack.empty(); }
+	bool can_redo() const { return !redo_stack.empty(); }
+
+	size_type undo_depth() const { return undo_stack.size(); }
+	size_type redo_depth() const { return redo_stack.size(); }
+
+	//! Forget all undo and redo points, keeping the current version.
+	void clear()
+	{
+		undo_stack.clear();
+		redo_stack.clear();
+	}
 
-//	template<typename CharU> friend
-//	std::basic_ostream<CharU>& operator<<(std::basic_ostream<CharU>& os, basic_rope<CharU> const& r)
-//	{
-//		for(auto c: r)
-//			os.put(c);
-//		return os;
-//	}
 private:
-	impl_type impl;
+	rope_type version;
+	size_type max_undo;
+	std::deque<rope_type> undo_stack;
+	std::vector<rope_type> redo_stack;
 };
 
 using rope = basic_rope<char>;
@@ -337,6 +1454,11 @@ using wrope = basic_rope<wchar_t>;
 using u16rope = basic_rope<char16_t>;
 using u32rope = basic_rope<char32_t>;
 
+using rope_history = basic_rope_history<char>;
+using wrope_history = basic_rope_history<wchar_t>;
+using u16rope_history = basic_rope_history<char16_t>;
+using u32rope_history = basic_rope_history<char32_t>;
+
 namespace literals {
 
 rope operator "" _r(char const* s, std::size_t n) { return rope{s, n}; }
@@ -349,14 +1471,4 @@ u32rope operator "" _r32(char32_t const* s, std::size_t n) { return u32rope{s, n
 } // namespace rope_utils
 } // namespace header_only_library
 
-//template<typename CharU>
-//std::basic_ostream<CharU>& operator<<(std::basic_ostream<CharU>& os,
-//	header_only_library::rope::basic_rope<CharU> const& r)
-//{
-//	for(auto c: r)
-//		os.put(c);
-//	return os;
-//}
-
-
 #endif // HEADER_ONLY_LIBRARY_ROPE_H
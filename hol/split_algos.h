@@ -4,6 +4,22 @@
 #include <hol/misc_utils.h>
 //#include "macro_exceptions.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// SIMD delimiter search: SSE2 is always available on x86-64, AVX2
+// is selected at runtime. Define HOL_NO_SIMD to use the scalar code.
+#if !defined(HOL_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__)
+#define HOL_SIMD_X86
+#include <immintrin.h>
+#endif
+
 namespace header_only_library {
 namespace algorithm {
 namespace chr {
@@ -25,6 +41,227 @@ CharT* find_null_terminator(CharT* s)
 
 using namespace header_only_library::misc_utils;
 
+namespace detail {
+
+//=============================================================
+//== Delimiter search kernels
+//=============================================================
+//
+// Each kernel calls emit(pos) for every non-overlapping occurrence of
+// the n byte delimiter d in [p, e), left to right, exactly as repeated
+// std::search would find them. The scan stops early when emit() returns
+// false.
+//
+// The SIMD kernels compare a whole block against the first and the last
+// delimiter byte at once and only verify the (rare) candidates where
+// both match, so every delimiter in the block comes from one mask.
+
+template<typename Emit>
+void scan_scalar(char const* p, char const* e, char const* d, std::size_t n, Emit&& emit)
+{
+	while(std::size_t(e - p) >= n)
+	{
+		p = static_cast<char const*>(std::memchr(p, d[0], std::size_t(e - p) - n + 1));
+
+		if(!p)
+			return;
+
+		if(n == 1 || !std::memcmp(p + 1, d + 1, n - 1))
+		{
+			if(!emit(p))
+				return;
+			p += n;
+		}
+		else
+			++p;
+	}
+}
+
+#ifdef HOL_SIMD_X86
+
+// returns the new skip position or nullptr to stop
+template<typename Emit>
+char const* emit_candidates(unsigned mask, char const* p, char const* skip,
+	char const* d, std::size_t n, Emit& emit)
+{
+	while(mask)
+	{
+		auto m = p + __builtin_ctz(mask);
+		mask &= mask - 1;
+
+		if(m < skip)
+			continue;
+
+		if(n <= 2 || !std::memcmp(m + 1, d + 1, n - 2))
+		{
+			if(!emit(m))
+				return nullptr;
+			skip = m + n;
+		}
+	}
+	return skip;
+}
+
+template<typename Emit>
+void scan_sse2(char const* p, char const* e, char const* d, std::size_t n, Emit&& emit)
+{
+	auto const first = _mm_set1_epi8(d[0]);
+	auto const last = _mm_set1_epi8(d[n - 1]);
+
+	char const* skip = p; // no match may start before this
+
+	for(; std::size_t(e - p) >= n + 15; p += 16)
+	{
+		auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+		auto const l = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + n - 1));
+
+		auto mask = unsigned(_mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(first, b), _mm_cmpeq_epi8(last, l))));
+
+		if(!(skip = emit_candidates(mask, p, skip, d, n, emit)))
+			return;
+	}
+
+	scan_scalar(std::max(p, skip), e, d, n, emit);
+}
+
+template<typename Emit>
+__attribute__((target("avx2")))
+void scan_avx2(char const* p, char const* e, char const* d, std::size_t n, Emit&& emit)
+{
+	auto const first = _mm256_set1_epi8(d[0]);
+	auto const last = _mm256_set1_epi8(d[n - 1]);
+
+	char const* skip = p; // no match may start before this
+
+	for(; std::size_t(e - p) >= n + 31; p += 32)
+	{
+		auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+		auto const l = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + n - 1));
+
+		auto mask = unsigned(_mm256_movemask_epi8(
+			_mm256_and_si256(_mm256_cmpeq_epi8(first, b), _mm256_cmpeq_epi8(last, l))));
+
+		if(!(skip = emit_candidates(mask, p, skip, d, n, emit)))
+			return;
+	}
+
+	scan_sse2(std::max(p, skip), e, d, n, emit);
+}
+
+inline bool cpu_has_avx2()
+{
+#ifdef __AVX2__
+	return true;
+#else
+	static bool const has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+#endif
+}
+
+#endif // HOL_SIMD_X86
+
+/**
+ * Call emit(pos) for each non-overlapping occurrence of
+ * the delimiter [d, d + n) in [p, e) using the best
+ * kernel the CPU supports.
+ */
+template<typename Emit>
+void scan(char const* p, char const* e, char const* d, std::size_t n, Emit&& emit)
+{
+	if(std::size_t(e - p) < n)
+		return;
+
+#ifdef HOL_SIMD_X86
+	if(cpu_has_avx2())
+		scan_avx2(p, e, d, n, emit);
+	else
+		scan_sse2(p, e, d, n, emit);
+#else
+	scan_scalar(p, e, d, n, emit);
+#endif
+}
+
+/**
+ * Find the first occurrence of the delimiter [d, d + n)
+ * in [p, e).
+ * @return The position of the delimiter or e if not found.
+ */
+inline char const* search(char const* p, char const* e, char const* d, std::size_t n)
+{
+	char const* found = e;
+	scan(p, e, d, n, [&](char const* m){ found = m; return false; });
+	return found;
+}
+
+inline char* search(char* p, char* e, char const* d, std::size_t n)
+{
+	return p + (search(static_cast<char const*>(p), e, d, n) - p);
+}
+
+template<typename CharT>
+CharT* search(CharT* p, CharT* e, CharT const* d, std::size_t n)
+{
+	return std::search(p, e, d, d + n);
+}
+
+// Iterators known to address contiguous char storage.
+template<typename Iter>
+struct is_contiguous_char_iter
+: std::integral_constant<bool
+	, std::is_same<Iter, char*>::value
+	|| std::is_same<Iter, char const*>::value
+	|| std::is_same<Iter, std::string::iterator>::value
+	|| std::is_same<Iter, std::string::const_iterator>::value
+	|| std::is_same<Iter, std::vector<char>::iterator>::value
+	|| std::is_same<Iter, std::vector<char>::const_iterator>::value> {};
+
+template<typename Iter>
+char const* char_ptr(Iter i) { return std::addressof(*i); }
+
+template<typename SearchIter, typename DelimIter, typename Func>
+void for_each_match(SearchIter beg_s, SearchIter end_s, DelimIter beg_d, DelimIter end_d,
+	Func&& func, std::false_type)
+{
+	auto size_d = std::distance(beg_d, end_d);
+
+	SearchIter pos;
+	while((pos = std::search(beg_s, end_s, beg_d, end_d)) != end_s)
+	{
+		func(pos);
+		beg_s = std::next(pos, size_d);
+	}
+}
+
+template<typename SearchIter, typename DelimIter, typename Func>
+void for_each_match(SearchIter beg_s, SearchIter end_s, DelimIter beg_d, DelimIter end_d,
+	Func&& func, std::true_type)
+{
+	auto size_d = std::size_t(std::distance(beg_d, end_d));
+
+	if(std::size_t(std::distance(beg_s, end_s)) < size_d)
+		return;
+
+	auto const p = char_ptr(beg_s);
+
+	scan(p, p + std::distance(beg_s, end_s), char_ptr(beg_d), size_d,
+		[&](char const* m){ func(std::next(beg_s, m - p)); return true; });
+}
+
+/**
+ * Call func(pos) for every non-overlapping occurrence of
+ * [beg_d, end_d) in [beg_s, end_s).
+ */
+template<typename SearchIter, typename DelimIter, typename Func>
+void for_each_match(SearchIter beg_s, SearchIter end_s, DelimIter beg_d, DelimIter end_d, Func&& func)
+{
+	for_each_match(beg_s, end_s, beg_d, end_d, std::forward<Func>(func),
+		std::integral_constant<bool, is_contiguous_char_iter<SearchIter>::value
+			&& is_contiguous_char_iter<DelimIter>::value>{});
+}
+
+} // namespace detail
+
 /**
  *
  * Split a buffer by a delimiter.
@@ -50,17 +287,16 @@ void split(SearchIter beg_s, SearchIter end_s, DelimIter beg_d, DelimIter end_d,
 	HOL_ASSERT_MSG(size_d, "delimiter cannot be empty");
 
 	std::size_t count = 0U;
-	SearchIter pos;
 
-	while((pos = std::search(beg_s, end_s, beg_d, end_d)) != end_s)
+	detail::for_each_match(beg_s, end_s, beg_d, end_d, [&](SearchIter pos)
 	{
 		out.insert(beg_s, pos);
 		beg_s = std::next(pos, size_d);
 		++count;
-	}
+	});
 
-	if(count || pos - beg_s)
-		out.insert(beg_s, pos);
+	if(count || end_s - beg_s)
+		out.insert(beg_s, end_s);
 }
 
 template<typename SearchIter, typename DelimIter, typename Inserter>
@@ -70,19 +306,384 @@ void split_fold(SearchIter beg_s, SearchIter end_s, DelimIter beg_d, DelimIter e
 
 	HOL_ASSERT_MSG(size_d, "delimiter cannot be empty");
 
-	std::size_t count = 0U;
-	SearchIter pos;
-
-	while((pos = std::search(beg_s, end_s, beg_d, end_d)) != end_s)
+	detail::for_each_match(beg_s, end_s, beg_d, end_d, [&](SearchIter pos)
 	{
 		if(pos - beg_s)
 			out.insert(beg_s, pos);
 		beg_s = std::next(pos, size_d);
-		++count;
+	});
+
+	if(end_s - beg_s)
+		out.insert(beg_s, end_s);
+}
+
+//=============================================================
+//== Character set splitting
+//=============================================================
+
+namespace detail {
+
+#ifdef HOL_SIMD_X86
+
+// The set's members below 0x80 are stored as a 16 byte table indexed by
+// the low nibble of a byte, each entry holding one bit per high nibble.
+// Two pshufb lookups classify a whole block in constant time whatever
+// the size of the set. Bytes >= 0x80 select no bit so never match.
+//
+// The find functions scan forwards and the rfind functions scan
+// backwards over whole blocks. They return the first (last) byte whose
+// membership equals `want` or, if there is none, the bounds of the
+// unscanned remainder: the start of the tail (the end of the head).
+
+//! A bit set for each byte in the 16 byte block at p that is not in the set.
+__attribute__((target("ssse3")))
+inline unsigned set_misses_ssse3(char const* p, __m128i table)
+{
+	auto const bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+	auto const low = _mm_set1_epi8(0x0f);
+
+	auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+	auto const row = _mm_shuffle_epi8(table, _mm_and_si128(b, low));
+	auto const bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(b, 4), low));
+
+	return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128())));
+}
+
+//! A bit set for each byte in the 32 byte block at p that is not in the set.
+__attribute__((target("avx2")))
+inline unsigned set_misses_avx2(char const* p, __m256i table)
+{
+	auto const bits = _mm256_setr_epi8(
+		1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+		1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+	auto const low = _mm256_set1_epi8(0x0f);
+
+	auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+	auto const row = _mm256_shuffle_epi8(table, _mm256_and_si256(b, low));
+	auto const bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(b, 4), low));
+
+	return unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256())));
+}
+
+__attribute__((target("ssse3")))
+inline char const* find_in_set_ssse3(char const* p, char const* e,
+	std::uint8_t const* nibbles, bool want)
+{
+	auto const table = _mm_loadu_si128(reinterpret_cast<__m128i const*>(nibbles));
+
+	for(; e - p >= 16; p += 16)
+	{
+		auto const misses = set_misses_ssse3(p, table);
+
+		if(auto mask = want ? ~misses & 0xFFFFU : misses)
+			return p + __builtin_ctz(mask);
 	}
 
-	if(pos - beg_s)
+	return p;
+}
+
+__attribute__((target("ssse3")))
+inline char const* rfind_in_set_ssse3(char const* p, char const* e,
+	std::uint8_t const* nibbles, bool want)
+{
+	auto const table = _mm_loadu_si128(reinterpret_cast<__m128i const*>(nibbles));
+
+	for(; e - p >= 16; e -= 16)
+	{
+		auto const misses = set_misses_ssse3(e - 16, table);
+
+		if(auto mask = want ? ~misses & 0xFFFFU : misses)
+			return e - 16 + (31 - __builtin_clz(mask));
+	}
+
+	return e;
+}
+
+__attribute__((target("avx2")))
+inline char const* find_in_set_avx2(char const* p, char const* e,
+	std::uint8_t const* nibbles, bool want)
+{
+	auto const table = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128(reinterpret_cast<__m128i const*>(nibbles)));
+
+	for(; e - p >= 32; p += 32)
+	{
+		auto const misses = set_misses_avx2(p, table);
+
+		if(auto mask = want ? ~misses : misses)
+			return p + __builtin_ctz(mask);
+	}
+
+	return find_in_set_ssse3(p, e, nibbles, want);
+}
+
+__attribute__((target("avx2")))
+inline char const* rfind_in_set_avx2(char const* p, char const* e,
+	std::uint8_t const* nibbles, bool want)
+{
+	auto const table = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128(reinterpret_cast<__m128i const*>(nibbles)));
+
+	for(; e - p >= 32; e -= 32)
+	{
+		auto const misses = set_misses_avx2(e - 32, table);
+
+		if(auto mask = want ? ~misses : misses)
+			return e - 32 + (31 - __builtin_clz(mask));
+	}
+
+	return rfind_in_set_ssse3(p, e, nibbles, want);
+}
+
+inline bool cpu_has_ssse3()
+{
+#ifdef __SSSE3__
+	return true;
+#else
+	static bool const has_ssse3 = __builtin_cpu_supports("ssse3");
+	return has_ssse3;
+#endif
+}
+
+#endif // HOL_SIMD_X86
+
+} // namespace detail
+
+/**
+ * A set of characters compiled once into a 256 bit membership
+ * table so that testing a character costs the same whatever
+ * the size of the set. Characters beyond the table (wide
+ * characters only) are kept in a (usually empty) list.
+ *
+ * For char sets whose members are all ASCII the searches
+ * classify 16 or 32 bytes at a time using pshufb when the
+ * CPU supports it.
+ */
+template<typename CharT>
+class basic_char_set
+{
+	using uchar_type = std::make_unsigned_t<CharT>;
+
+public:
+	basic_char_set() = default;
+
+	template<typename Iter>
+	basic_char_set(Iter beg, Iter end) { for(; beg != end; ++beg) insert(*beg); }
+
+	//! Every character of the null terminated string s.
+	basic_char_set(CharT const* s) { for(; *s; ++s) insert(*s); }
+
+	template<typename Traits, typename Alloc>
+	basic_char_set(std::basic_string<CharT, Traits, Alloc> const& s)
+	: basic_char_set(std::begin(s), std::end(s)) {}
+
+	void insert(CharT c)
+	{
+		auto const u = uchar_type(c);
+
+		if(u > 0xFF)
+		{
+			if(!contains(c))
+				m_wide.push_back(c);
+			m_ascii = false;
+			return;
+		}
+
+		m_bits[u >> 6] |= std::uint64_t(1) << (u & 63);
+
+		if(u < 0x80)
+			m_nibbles[u & 0x0F] |= std::uint8_t(1U << (u >> 4));
+		else
+			m_ascii = false;
+	}
+
+	bool contains(CharT c) const
+	{
+		auto const u = uchar_type(c);
+
+		if(u > 0xFF)
+			return std::find(std::begin(m_wide), std::end(m_wide), c) != std::end(m_wide);
+
+		return (m_bits[u >> 6] >> (u & 63)) & 1;
+	}
+
+	//! The first member of the set in [p, e) or e if there is none.
+	CharT const* find_first_of(CharT const* p, CharT const* e) const
+		{ return find(p, e, true); }
+
+	//! The first non-member of the set in [p, e) or e if there is none.
+	CharT const* find_first_not_of(CharT const* p, CharT const* e) const
+		{ return find(p, e, false); }
+
+	CharT* find_first_of(CharT* p, CharT* e) const
+		{ return p + (find(p, e, true) - p); }
+
+	CharT* find_first_not_of(CharT* p, CharT* e) const
+		{ return p + (find(p, e, false) - p); }
+
+	//! The last member of the set in [p, e) or e if there is none.
+	CharT const* find_last_of(CharT const* p, CharT const* e) const
+		{ return rfind(p, e, true); }
+
+	//! The last non-member of the set in [p, e) or e if there is none.
+	CharT const* find_last_not_of(CharT const* p, CharT const* e) const
+		{ return rfind(p, e, false); }
+
+	CharT* find_last_of(CharT* p, CharT* e) const
+		{ return p + (rfind(p, e, true) - p); }
+
+	CharT* find_last_not_of(CharT* p, CharT* e) const
+		{ return p + (rfind(p, e, false) - p); }
+
+private:
+	CharT const* find(CharT const* p, CharT const* e, bool want) const
+	{
+		// most searches (trimming) end on the first character
+		if(p != e && contains(*p) == want)
+			return p;
+
+		p = find_simd(p, e, want, std::is_same<CharT, char>{});
+
+		while(p != e && contains(*p) != want)
+			++p;
+
+		return p;
+	}
+
+	CharT const* rfind(CharT const* p, CharT const* e, bool want) const
+	{
+		if(p != e && contains(e[-1]) == want)
+			return e - 1;
+
+		auto r = rfind_simd(p, e, want, std::is_same<CharT, char>{});
+
+		if(r != e && contains(*r) == want)
+			return r;
+
+		// nothing in [r, e) matched
+		while(r != p)
+			if(contains(*--r) == want)
+				return r;
+
+		return e;
+	}
+
+	CharT const* find_simd(CharT const* p, CharT const*, bool, std::false_type) const
+		{ return p; }
+
+	CharT const* find_simd(CharT const* p, CharT const* e, bool want, std::true_type) const
+	{
+#ifdef HOL_SIMD_X86
+		if(m_ascii && detail::cpu_has_avx2())
+			return detail::find_in_set_avx2(p, e, m_nibbles, want);
+
+		if(m_ascii && detail::cpu_has_ssse3())
+			return detail::find_in_set_ssse3(p, e, m_nibbles, want);
+#else
+		(void) e;
+		(void) want;
+#endif
+		return p;
+	}
+
+	CharT const* rfind_simd(CharT const*, CharT const* e, bool, std::false_type) const
+		{ return e; }
+
+	CharT const* rfind_simd(CharT const* p, CharT const* e, bool want, std::true_type) const
+	{
+#ifdef HOL_SIMD_X86
+		if(m_ascii && detail::cpu_has_avx2())
+			return detail::rfind_in_set_avx2(p, e, m_nibbles, want);
+
+		if(m_ascii && detail::cpu_has_ssse3())
+			return detail::rfind_in_set_ssse3(p, e, m_nibbles, want);
+#else
+		(void) p;
+		(void) want;
+#endif
+		return e;
+	}
+
+	std::uint64_t m_bits[4] = {};
+	std::uint8_t m_nibbles[16] = {};
+	std::basic_string<CharT> m_wide;
+	bool m_ascii = true;
+};
+
+using char_set = basic_char_set<char>;
+using wchar_set = basic_char_set<wchar_t>;
+using u16char_set = basic_char_set<char16_t>;
+using u32char_set = basic_char_set<char32_t>;
+
+namespace detail {
+
+template<typename SearchIter, typename CharT>
+SearchIter find_in_set(SearchIter beg_s, SearchIter end_s,
+	basic_char_set<CharT> const& set, std::false_type)
+{
+	return std::find_if(beg_s, end_s, [&](CharT c){ return set.contains(c); });
+}
+
+template<typename SearchIter, typename CharT>
+SearchIter find_in_set(SearchIter beg_s, SearchIter end_s,
+	basic_char_set<CharT> const& set, std::true_type)
+{
+	if(beg_s == end_s)
+		return end_s;
+
+	auto const p = char_ptr(beg_s);
+	return std::next(beg_s, set.find_first_of(p, p + std::distance(beg_s, end_s)) - p);
+}
+
+template<typename SearchIter, typename CharT>
+SearchIter find_in_set(SearchIter beg_s, SearchIter end_s, basic_char_set<CharT> const& set)
+{
+	return find_in_set(beg_s, end_s, set, std::integral_constant<bool,
+		std::is_same<CharT, char>::value && is_contiguous_char_iter<SearchIter>::value>{});
+}
+
+} // namespace detail
+
+/**
+ * Split a buffer wherever any character from a set of delimiters
+ * occurs. The rules for the number of pieces are the same as
+ * for split(), every delimiting character counting as one delimiter.
+ */
+template<typename SearchIter, typename CharT, typename Inserter>
+void split_from(SearchIter beg_s, SearchIter end_s, basic_char_set<CharT> const& delims, Inserter out)
+{
+	if(beg_s == end_s)
+		return;
+
+	SearchIter pos;
+
+	while((pos = detail::find_in_set(beg_s, end_s, delims)) != end_s)
+	{
 		out.insert(beg_s, pos);
+		beg_s = std::next(pos);
+	}
+
+	out.insert(beg_s, end_s);
+}
+
+/**
+ * Like split_from() but runs of delimiting characters
+ * produce no empty pieces.
+ */
+template<typename SearchIter, typename CharT, typename Inserter>
+void split_from_fold(SearchIter beg_s, SearchIter end_s, basic_char_set<CharT> const& delims, Inserter out)
+{
+	SearchIter pos;
+
+	while((pos = detail::find_in_set(beg_s, end_s, delims)) != end_s)
+	{
+		if(pos != beg_s)
+			out.insert(beg_s, pos);
+		beg_s = std::next(pos);
+	}
+
+	if(beg_s != end_s)
+		out.insert(beg_s, end_s);
 }
 
 template<typename Container>//, typename Contained>
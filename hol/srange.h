@@ -28,6 +28,10 @@
 #include <utility>
 #include <vector>
 
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
 #include <cassert>
 
 #include "range.h"
@@ -87,6 +91,14 @@ public:
 	{
 		return {basic_range<CharT>::m_beg, basic_range<CharT>::m_end};
 	}
+
+#if __cplusplus >= 201703L
+	std::basic_string_view<typename std::remove_const<CharT>::type>
+	string_view() const noexcept
+	{
+		return {basic_range<CharT>::m_beg, basic_range<CharT>::size()};
+	}
+#endif
 };
 
 namespace detail {
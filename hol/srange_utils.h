@@ -23,8 +23,15 @@
 //
 
 #include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
 #include <vector>
 
+#include "from_chars.h"
 #include "srange.h"
 #include "split_algos.h"
 
@@ -43,86 +50,128 @@ constexpr auto const& ws(char32_t) { return U" \t\n\r\f\v\0"; }
 } // namespace detail
 
 template<typename Char>
-basic_range<Char> trim_left(basic_range<Char> r, basic_range<Char> ws = detail::ws(Char()))
-{
-	auto pos = std::find_if_not(std::begin(r), std::end(r), [&](auto c)
-		{ return std::find(std::begin(ws), std::end(ws), c) != std::end(ws); });
+using char_set_for = algorithm::basic_char_set<std::remove_const_t<Char>>;
+
+namespace detail {
 
-	return make_range(pos, std::end(r));
+//! The default whitespace compiled once for the trim functions.
+template<typename Char>
+char_set_for<Char> const& ws_set()
+{
+	static char_set_for<Char> const set(std::begin(ws(Char())), std::end(ws(Char())));
+	return set;
 }
 
+} // namespace detail
+
 template<typename Char>
-basic_range<Char> trim_right(basic_range<Char> r, basic_range<Char> ws = detail::ws(Char()))
+basic_range<Char> trim_left(basic_range<Char> r, char_set_for<Char> const& ws)
 {
-	auto rpos = std::find_if_not(std::rbegin(r), std::rend(r), [&](auto c)
-		{ return std::find(std::begin(ws), std::end(ws), c) != std::end(ws); });
+	return make_range(ws.find_first_not_of(r.data(), r.data() + r.size()), r.data() + r.size());
+}
 
-	return make_range(std::begin(r), rpos.base());
+template<typename Char>
+basic_range<Char> trim_right(basic_range<Char> r, char_set_for<Char> const& ws)
+{
+	auto const end = r.data() + r.size();
+	auto const pos = ws.find_last_not_of(r.data(), end);
+	return make_range(r.data(), pos == end ? r.data() : pos + 1);
 }
 
 template<typename Char>
-basic_range<Char> trim(basic_range<Char> r, basic_range<Char> ws = detail::ws(Char()))
+basic_range<Char> trim(basic_range<Char> r, char_set_for<Char> const& ws)
 {
 	return trim_left(trim_right(r, ws), ws);
 }
 
+template<typename Char>
+basic_range<Char> trim_left(basic_range<Char> r, basic_range<Char> ws)
+	{ return trim_left(r, char_set_for<Char>(std::begin(ws), std::end(ws))); }
+
+template<typename Char>
+basic_range<Char> trim_right(basic_range<Char> r, basic_range<Char> ws)
+	{ return trim_right(r, char_set_for<Char>(std::begin(ws), std::end(ws))); }
+
+template<typename Char>
+basic_range<Char> trim(basic_range<Char> r, basic_range<Char> ws)
+	{ return trim(r, char_set_for<Char>(std::begin(ws), std::end(ws))); }
+
+template<typename Char>
+basic_range<Char> trim_left(basic_range<Char> r)
+	{ return trim_left(r, detail::ws_set<Char>()); }
+
+template<typename Char>
+basic_range<Char> trim_right(basic_range<Char> r)
+	{ return trim_right(r, detail::ws_set<Char>()); }
+
+template<typename Char>
+basic_range<Char> trim(basic_range<Char> r)
+	{ return trim(r, detail::ws_set<Char>()); }
+
 // Number conversions
 
-inline
-int stoi(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+namespace detail {
+
+//! Like the std::sto* functions but without needing a null terminator.
+template<typename Integer, typename Char>
+Integer sto(basic_range<Char> r, std::size_t* pos, int base, char const* name)
 {
-	auto ptr = r.data();
-	auto i = std::strtol(r.data(), &ptr, base);
+	Integer i;
+	auto const res = string_conversions::scan_integer(r.data(), r.data() + r.size(), i, base);
 
-	if(ptr == r.data())
-		throw std::invalid_argument("invalid argument: stoi(" + std::string(std::begin(r), std::end(r)) + ")");
+	if(res.ec == std::errc::invalid_argument)
+		throw std::invalid_argument("invalid argument: " + std::string(name) + "(" + std::string(std::begin(r), std::end(r)) + ")");
 
-	if(i > std::numeric_limits<int>::max()
-	|| i < std::numeric_limits<int>::min())
-		throw std::out_of_range("out of range: stoi(" + std::string(std::begin(r), std::end(r)) + ")");
+	if(res.ec == std::errc::result_out_of_range)
+		throw std::out_of_range("out of range: " + std::string(name) + "(" + std::string(std::begin(r), std::end(r)) + ")");
 
 	if(pos)
-		*pos = std::size_t(std::distance(r.data(), ptr));
+		*pos = std::size_t(std::distance(r.data(), res.ptr));
 
-	return int(i);
+	return i;
 }
 
+} // namespace detail
+
 inline
-long stol(basic_range<char> r, std::size_t* pos = 0, int base = 10)
-{
-	auto ptr = r.data();
-	auto i = std::strtoll(r.data(), &ptr, base);
+int stoi(basic_range<char const> r, std::size_t* pos = 0, int base = 10)
+	{ return detail::sto<int>(r, pos, base, "stoi"); }
 
-	if(ptr == r.data())
-		throw std::invalid_argument("invalid argument: stol(" + std::string(std::begin(r), std::end(r)) + ")");
+inline
+long stol(basic_range<char const> r, std::size_t* pos = 0, int base = 10)
+	{ return detail::sto<long>(r, pos, base, "stol"); }
 
-	if(i > std::numeric_limits<long>::max()
-	|| i < std::numeric_limits<long>::min())
-		throw std::out_of_range("out of range: stol(" + std::string(std::begin(r), std::end(r)) + ")");
+inline
+long long stoll(basic_range<char const> r, std::size_t* pos = 0, int base = 10)
+	{ return detail::sto<long long>(r, pos, base, "stoll"); }
 
-	if(pos)
-		*pos = std::size_t(std::distance(r.data(), ptr));
+inline
+unsigned long stoul(basic_range<char const> r, std::size_t* pos = 0, int base = 10)
+	{ return detail::sto<unsigned long>(r, pos, base, "stoul"); }
 
-	return int(i);
-}
+inline
+unsigned long long stoull(basic_range<char const> r, std::size_t* pos = 0, int base = 10)
+	{ return detail::sto<unsigned long long>(r, pos, base, "stoull"); }
 
 inline
-long long stoll(basic_range<char> r, std::size_t* pos = 0, int base = 10)
-{
-	auto ptr = r.data();
-	auto i = std::strtoll(r.data(), &ptr, base);
+int stoi(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+	{ return stoi(basic_range<char const>(r.data(), r.size()), pos, base); }
 
-	if(ptr == r.data())
-		throw std::invalid_argument("invalid argument: stoll(" + std::string(std::begin(r), std::end(r)) + ")");
+inline
+long stol(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+	{ return stol(basic_range<char const>(r.data(), r.size()), pos, base); }
 
-	if(errno == ERANGE)
-		throw std::out_of_range("out of range: stoll(" + std::string(std::begin(r), std::end(r)) + ")");
+inline
+long long stoll(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+	{ return stoll(basic_range<char const>(r.data(), r.size()), pos, base); }
 
-	if(pos)
-		*pos = std::size_t(std::distance(r.data(), ptr));
+inline
+unsigned long stoul(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+	{ return stoul(basic_range<char const>(r.data(), r.size()), pos, base); }
 
-	return int(i);
-}
+inline
+unsigned long long stoull(basic_range<char> r, std::size_t* pos = 0, int base = 10)
+	{ return stoull(basic_range<char const>(r.data(), r.size()), pos, base); }
 
 // finding
 
@@ -215,7 +264,7 @@ basic_srange<CharT> extract_delimited_text(
 template<typename CharT>
 std::vector<basic_srange<CharT>> split(
 	basic_srange<CharT> s,
-		basic_srange<CharT const> t = make_srange(algorithm::chr::space(CharT())))
+		basic_srange<std::add_const_t<CharT>> t = make_srange(algorithm::chr::space(CharT())))
 {
 	std::vector<basic_srange<CharT>> v;
 	algorithm::split(std::begin(s), std::end(s), std::begin(t), std::end(t), algorithm::inserter(v));
@@ -225,13 +274,13 @@ std::vector<basic_srange<CharT>> split(
 template<typename CharT, std::size_t N>
 std::vector<basic_srange<CharT>> split(
 	basic_srange<CharT> s,
-		CharT const(&t)[N])
-			{ return split(s, basic_srange<CharT const>(t)); }
+		std::remove_const_t<CharT> const(&t)[N])
+			{ return split(s, basic_srange<std::add_const_t<CharT>>(t)); }
 
 template<typename CharT>
 std::vector<basic_srange<CharT>> split_fold(
 	basic_srange<CharT> s,
-		basic_srange<CharT const> t = make_srange(algorithm::chr::space(CharT())))
+		basic_srange<std::add_const_t<CharT>> t = make_srange(algorithm::chr::space(CharT())))
 {
 	std::vector<basic_srange<CharT>> v;
 	algorithm::split_fold(std::begin(s), std::end(s), std::begin(t), std::end(t), algorithm::inserter(v));
@@ -241,8 +290,217 @@ std::vector<basic_srange<CharT>> split_fold(
 template<typename CharT, std::size_t N>
 std::vector<basic_srange<CharT>> split_fold(
 	basic_srange<CharT> s,
+		std::remove_const_t<CharT> const(&t)[N])
+			{ return split_fold(s, basic_srange<std::add_const_t<CharT>>(t)); }
+
+template<typename CharT>
+std::vector<basic_srange<CharT>> split_from(
+	basic_srange<CharT> s,
+		algorithm::basic_char_set<std::remove_const_t<CharT>> const& delims)
+{
+	std::vector<basic_srange<CharT>> v;
+	algorithm::split_from(std::begin(s), std::end(s), delims, algorithm::inserter(v));
+	return v;
+}
+
+template<typename CharT, std::size_t N>
+std::vector<basic_srange<CharT>> split_from(
+	basic_srange<CharT> s,
+		std::remove_const_t<CharT> const(&delims)[N])
+			{ return split_from(s, algorithm::basic_char_set<std::remove_const_t<CharT>>(delims)); }
+
+template<typename CharT>
+std::vector<basic_srange<CharT>> split_from_fold(
+	basic_srange<CharT> s,
+		algorithm::basic_char_set<std::remove_const_t<CharT>> const& delims)
+{
+	std::vector<basic_srange<CharT>> v;
+	algorithm::split_from_fold(std::begin(s), std::end(s), delims, algorithm::inserter(v));
+	return v;
+}
+
+template<typename CharT, std::size_t N>
+std::vector<basic_srange<CharT>> split_from_fold(
+	basic_srange<CharT> s,
+		std::remove_const_t<CharT> const(&delims)[N])
+			{ return split_from_fold(s, algorithm::basic_char_set<std::remove_const_t<CharT>>(delims)); }
+
+//=============================================================
+//== Lazy splitting
+//=============================================================
+
+/**
+ * An input range over the pieces of a string split by a delimiter,
+ * with the same rules as split(), but each piece is only found when
+ * the iteration reaches it. Nothing is allocated and the rest of the
+ * string is never scanned when the iteration stops early.
+ *
+ * The pieces refer into the original string, which must outlive
+ * them. The view copies the delimiter.
+ *
+ * Usage:
+ *
+ *	for(auto field: hol::split_view(line, ","))
+ *		process(field);
+ *
+ *	auto third = *std::next(hol::split_n(line, ",", 3).begin(), 2);
+ */
+template<typename CharT>
+class basic_split_view
+{
+	using delim_type = std::basic_string<std::remove_const_t<CharT>>;
+
+public:
+	using value_type = basic_srange<CharT>;
+
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+	/**
+	 * @param s The string to split.
+	 * @param t The delimiter, which may not be empty.
+	 * @param max_pieces Stop after this many pieces.
+	 */
+	basic_split_view(basic_srange<CharT> s, basic_srange<std::add_const_t<CharT>> t,
+		std::size_t max_pieces = npos)
+	: m_beg(s.data()), m_end(s.data() + s.size()), m_delim(std::begin(t), std::end(t)), m_max(max_pieces)
+	{
+		HOL_ASSERT_MSG(!m_delim.empty(), "delimiter cannot be empty");
+	}
+
+	class iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = basic_srange<CharT>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = value_type const*;
+		using reference = value_type const&;
+
+		iterator() = default;
+
+		reference operator*() const { return piece; }
+		pointer operator->() const { return &piece; }
+
+		iterator& operator++()
+		{
+			if(last || count == view->m_max)
+			{
+				view = nullptr;
+				return *this;
+			}
+
+			auto const e = view->m_end;
+			auto const m = algorithm::detail::search(pos, e, view->m_delim.data(), view->m_delim.size());
+
+			piece = value_type(pos, m);
+
+			if(m == e)
+				last = true;
+			else
+				pos = m + view->m_delim.size();
+
+			++count;
+			return *this;
+		}
+
+		iterator operator++(int) { auto i = *this; ++(*this); return i; }
+
+		bool operator==(iterator const& other) const { return view == other.view; }
+		bool operator!=(iterator const& other) const { return !(*this == other); }
+
+	private:
+		friend class basic_split_view;
+
+		explicit iterator(basic_split_view const* view)
+		: view(view->m_beg == view->m_end ? nullptr : view), pos(view->m_beg)
+		{
+			if(this->view)
+				++(*this);
+		}
+
+		basic_split_view const* view = nullptr;
+		CharT* pos = nullptr;
+		value_type piece;
+		std::size_t count = 0;
+		bool last = false;
+	};
+
+	iterator begin() const { return iterator(this); }
+	iterator end() const { return {}; }
+
+private:
+	CharT* m_beg;
+	CharT* m_end;
+	delim_type m_delim;
+	std::size_t m_max;
+};
+
+template<typename CharT>
+constexpr std::size_t basic_split_view<CharT>::npos;
+
+template<typename CharT>
+basic_split_view<CharT> split_view(
+	basic_srange<CharT> s,
+		basic_srange<std::add_const_t<CharT>> t = make_srange(algorithm::chr::space(CharT())))
+			{ return basic_split_view<CharT>(s, t); }
+
+template<typename CharT, std::size_t N>
+basic_split_view<CharT> split_view(
+	basic_srange<CharT> s,
+		std::remove_const_t<CharT> const(&t)[N])
+			{ return split_view(s, basic_srange<std::add_const_t<CharT>>(t)); }
+
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+basic_split_view<CharT const> split_view(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		CharT const(&t)[N])
+			{ return split_view(make_srange(s), t); }
+
+// the pieces would outlive the string
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+basic_split_view<CharT const> split_view(
+	std::basic_string<CharT, Traits, Alloc>&& s,
+		CharT const(&t)[N]) = delete;
+
+/**
+ * Like split_view() but stop after the first n pieces.
+ */
+template<typename CharT>
+basic_split_view<CharT> split_n(
+	basic_srange<CharT> s,
+		basic_srange<std::add_const_t<CharT>> t, std::size_t n)
+			{ return basic_split_view<CharT>(s, t, n); }
+
+template<typename CharT, std::size_t N>
+basic_split_view<CharT> split_n(
+	basic_srange<CharT> s,
+		std::remove_const_t<CharT> const(&t)[N], std::size_t n)
+			{ return split_n(s, basic_srange<std::add_const_t<CharT>>(t), n); }
+
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+basic_split_view<CharT const> split_n(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		CharT const(&t)[N], std::size_t n)
+			{ return split_n(make_srange(s), t, n); }
+
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+basic_split_view<CharT const> split_n(
+	std::basic_string<CharT, Traits, Alloc>&& s,
+		CharT const(&t)[N], std::size_t n) = delete;
+
+#if __cplusplus >= 201703L
+template<typename CharT, typename Traits, std::size_t N>
+basic_split_view<CharT const> split_view(
+	std::basic_string_view<CharT, Traits> s,
 		CharT const(&t)[N])
-			{ return split_fold(s, basic_srange<CharT const>(t)); }
+			{ return split_view(make_srange(s.data(), s.size()), t); }
+
+template<typename CharT, typename Traits, std::size_t N>
+basic_split_view<CharT const> split_n(
+	std::basic_string_view<CharT, Traits> s,
+		CharT const(&t)[N], std::size_t n)
+			{ return split_n(make_srange(s.data(), s.size()), t, n); }
+#endif
 
 } // namespace range_utils
 } // namespace header_only_library
@@ -22,8 +22,14 @@
 // SOFTWARE.
 //
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "from_chars.h"
 
 // FIXME: std::numeric_limits<Unsigned>::max_digits10 only works for FLOAT!!!
 
@@ -82,261 +88,106 @@ bool s_to_test(char const* s, char const* e)
 
 } // namespace detail
 
-/**
- *
- * @param s String to convert.
- * @param i Converted output. ONLY set if conversion succeeds.
- * @param base
- * @return Pointer to first unconverted character or nullptr on failure to convert.
- */
-template<typename Signed>
-char const* s_to_i(char const* s, Signed& i, int base = 10)
-{
-	static_assert(std::is_integral<Signed>::value, "s_to_i() requires an integral output value");
-	static_assert(std::is_signed<Signed>::value, "s_to_i() requires a signed output value, did you mean s_to_u()?");
-
-	char* end;
-	auto l = std::strtoll(s, &end, base);
+namespace detail {
 
-	if(l > std::numeric_limits<Signed>::max()
-	|| l < std::numeric_limits<Signed>::min())
-		return nullptr;
+template<typename Integer, typename CharT>
+CharT const* s_to_integer(CharT const* s, CharT const* end, Integer& i, int base)
+{
+	Integer n;
+	auto const r = scan_integer(s, end, n, base);
 
-	if(!detail::s_to_test(s, end))
+	if(r.ec != std::errc()
+	|| !std::all_of(r.ptr, end, [](CharT c){ return string_conversions::detail::is_space(c); }))
 		return nullptr;
 
-	i = static_cast<Signed>(l);
-
-	return end;
+	i = n;
+	return r.ptr;
 }
 
+} // namespace detail
+
+/**
+ * Convert a whole string to a signed integer. The input is the same
+ * as std::strtol() accepts, optionally followed by whitespace, but
+ * wide strings are parsed directly rather than narrowed first.
+ *
+ * @param s String to convert.
+ * @param i Converted output. ONLY set if conversion succeeds.
+ * @param base The number base, 0 or from 2 to 36.
+ * @return Pointer to first unconverted character or nullptr on failure to convert.
+ */
 template<typename CharT, typename Signed>
 CharT const* s_to_i(CharT const* s, Signed& i, int base = 10)
 {
-	char buf[std::numeric_limits<Signed>::max_digits10 + 1];
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
-		return nullptr;
-
-	if(auto* pos = s_to_i(buf, i, base))
-		return s + (pos - buf);
+	static_assert(std::is_integral<Signed>::value, "s_to_i() requires an integral output value");
+	static_assert(std::is_signed<Signed>::value, "s_to_i() requires a signed output value, did you mean s_to_u()?");
 
-	return nullptr;
+	return detail::s_to_integer(s, s + std::char_traits<CharT>::length(s), i, base);
 }
 
 template<typename CharT, typename Traits = std::char_traits<CharT>,
 	typename Alloc = std::allocator<CharT>, typename Signed>
 bool s_to_i(std::basic_string<CharT, Traits, Alloc> const& s, Signed& i, int base = 10)
 {
-	return bool(s_to_i(s.c_str(), i, base));
-}
-
-template<typename Unsigned>
-char const* s_to_u(char const* s, Unsigned& i, int base = 10)
-{
-	static_assert(std::is_integral<Unsigned>::value, "s_to_u() requires an integral output value");
-	static_assert(std::is_unsigned<Unsigned>::value, "s_to_u() requires an unsigned output value, did you mean s_to_i()?");
-
-	char* end;
-	auto l = std::strtoull(s, &end, base);
-
-	if(l > std::numeric_limits<Unsigned>::max())
-		return nullptr;
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	i = static_cast<Unsigned>(l);
+	static_assert(std::is_integral<Signed>::value, "s_to_i() requires an integral output value");
+	static_assert(std::is_signed<Signed>::value, "s_to_i() requires a signed output value, did you mean s_to_u()?");
 
-	return end;
+	return bool(detail::s_to_integer(s.data(), s.data() + s.size(), i, base));
 }
 
+//! Convert a whole string to an unsigned integer (see s_to_i()).
 template<typename CharT, typename Unsigned>
 CharT const* s_to_u(CharT const* s, Unsigned& i, int base = 10)
 {
-	char buf[std::numeric_limits<Unsigned>::max_digits10 + 1];
-
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
-		return nullptr;
-
-	if(auto* pos = s_to_u(buf, i, base))
-		return s + (pos - buf);
+	static_assert(std::is_integral<Unsigned>::value, "s_to_u() requires an integral output value");
+	static_assert(std::is_unsigned<Unsigned>::value, "s_to_u() requires an unsigned output value, did you mean s_to_i()?");
 
-	return nullptr;
+	return detail::s_to_integer(s, s + std::char_traits<CharT>::length(s), i, base);
 }
 
 template<typename CharT, typename Traits = std::char_traits<CharT>,
 	typename Alloc = std::allocator<CharT>, typename Unsigned>
-bool s_to_u(std::basic_string<CharT, Traits, Alloc>const& s, Unsigned& i, int base = 10)
-{
-	return bool(s_to_u(s.c_str(), i, base));
-}
-
-inline
-char const* s_to_i(char const* s, long int& i)
-{
-	char* end;
-	auto tmp = std::strtol(s, &end, 10);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	i = tmp;
-
-	return end;
-}
-
-template<typename CharT>
-CharT const* s_to_i(CharT const* s, long int& i)
-{
-	char buf[std::numeric_limits<decltype(i)>::max_digits10 + 1];
-
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
-		return nullptr;
-
-	if(auto* pos = s_to_i(buf, i))
-		return s + (pos - buf);
-
-	return nullptr;
-}
-
-template<typename CharT, typename Traits = std::char_traits<CharT>,
-	typename Alloc = std::allocator<CharT>>
-bool s_to_i(std::basic_string<CharT, Traits, Alloc>const& s, long int& i)
-{
-	return s_to_i(s.c_str(), i);
-}
-
-inline
-char const* s_to_i(char const* s, long long int& i)
-{
-	char* end;
-	auto tmp = std::strtoll(s, &end, 10);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	i = tmp;
-
-	return end;
-}
-
-template<typename CharT>
-CharT const* s_to_i(CharT const* s, long long int& i)
+bool s_to_u(std::basic_string<CharT, Traits, Alloc> const& s, Unsigned& i, int base = 10)
 {
-	char buf[std::numeric_limits<decltype(i)>::max_digits10 + 1];
-
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
-		return nullptr;
-
-	if(auto* pos = s_to_i(buf, i))
-		return s + (pos - buf);
-
-	return nullptr;
-}
-
-template<typename CharT, typename Traits = std::char_traits<CharT>,
-	typename Alloc = std::allocator<CharT>>
-bool s_to_i(std::basic_string<CharT, Traits, Alloc>const& s, long long int& i)
-{
-	return s_to_i(s.c_str(), i);
-}
-
-inline
-char const* s_to_u(char const* s, unsigned long int& u)
-{
-	char* end;
-	auto tmp = std::strtoul(s, &end, 10);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	u = tmp;
+	static_assert(std::is_integral<Unsigned>::value, "s_to_u() requires an integral output value");
+	static_assert(std::is_unsigned<Unsigned>::value, "s_to_u() requires an unsigned output value, did you mean s_to_i()?");
 
-	return end;
+	return bool(detail::s_to_integer(s.data(), s.data() + s.size(), i, base));
 }
 
-template<typename CharT>
-CharT const* s_to_u(CharT const* s, unsigned long int& u)
-{
-	char buf[std::numeric_limits<decltype(u)>::max_digits10 + 1];
-
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
-		return nullptr;
-
-	if(auto* pos = s_to_u(buf, u))
-		return s + (pos - buf);
-
-	return nullptr;
-}
+// TODO:
 
-template<typename CharT, typename Traits = std::char_traits<CharT>,
-	typename Alloc = std::allocator<CharT>>
-bool s_to_u(std::basic_string<CharT, Traits, Alloc>const& s, unsigned long int& u)
-{
-	return s_to_u(s.c_str(), u);
-}
+namespace detail {
 
-inline
-char const* s_to_u(char const* s, unsigned long long int& u)
+template<typename Real>
+char const* s_to_real(char const* s, Real& r)
 {
-	char* end;
-	auto tmp = std::strtoull(s, &end, 10);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	u = tmp;
-
-	return end;
-}
+	auto const end = s + std::strlen(s);
 
-template<typename CharT>
-CharT const* s_to_u(CharT const* s, unsigned long long int& u)
-{
-	char buf[std::numeric_limits<decltype(u)>::max_digits10 + 1];
+	Real n;
+	auto const res = scan_real(s, end, n);
 
-	if(auto* pos = detail::make_narrow(s, buf, sizeof(buf)))
-		*pos = '\0';
-	else
+	if(res.ec != std::errc() || !std::all_of(res.ptr, end, [](char c){ return is_space(c); }))
 		return nullptr;
 
-	if(auto* pos = s_to_u(buf, u))
-		return s + (pos - buf);
-
-	return nullptr;
-}
-
-template<typename CharT, typename Traits = std::char_traits<CharT>,
-	typename Alloc = std::allocator<CharT>>
-bool s_to_u(std::basic_string<CharT, Traits, Alloc>const& s, unsigned long long int& u)
-{
-	return s_to_u(s.c_str(), u);
+	r = n;
+	return res.ptr;
 }
 
-// TODO:
+} // namespace detail
 
+/**
+ * Convert a whole string to a float, correctly rounded and
+ * independent of the locale (see scan_real()).
+ *
+ * @param s String to convert.
+ * @param r Converted output. ONLY set if conversion succeeds.
+ * @return Pointer to first unconverted character or nullptr on failure to convert.
+ */
 inline
 char const* s_to_r(char const* s, float& r)
 {
-	char* end;
-	auto tmp = std::strtof(s, &end);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	r = tmp;
-
-	return end;
+	return detail::s_to_real(s, r);
 }
 
 template<typename CharT>
@@ -365,15 +216,7 @@ bool s_to_r(std::basic_string<CharT, Traits, Alloc>const& s, float& r)
 inline
 char const* s_to_r(char const* s, double& r)
 {
-	char* end;
-	auto tmp = std::strtod(s, &end);
-
-	if(!detail::s_to_test(s, end))
-		return nullptr;
-
-	r = tmp;
-
-	return end;
+	return detail::s_to_real(s, r);
 }
 
 template<typename CharT>
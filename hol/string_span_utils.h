@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <cassert>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <gsl/string_span>
@@ -252,24 +253,28 @@ constexpr cstring_span<char32_t> ws(char32_t) { return cstring_span<char32_t>(U"
 // standard library ones but they are more efficient for trimming
 // so they are in `detail` namespace.
 
+template<typename CSpanType>
+auto char_set_of(CSpanType t)
+{
+	return algorithm::basic_char_set<std::remove_const_t<typename CSpanType::element_type>>(t.begin(), t.end());
+}
+
 template<typename SpanType, typename CSpanType>
 typename SpanType::index_type find_first_not_of(SpanType s, CSpanType t)
 {
-	for(typename SpanType::index_type i = 0; i < s.size(); ++i)
-		if(std::find(t.begin(), t.end(), s[i]) == t.end())
-			return i;
+	auto const end = s.data() + s.size();
+	auto const pos = char_set_of(t).find_first_not_of(s.data(), end);
 
-	return -1; // 0?
+	return pos == end ? -1 : typename SpanType::index_type(pos - s.data());
 }
 
 template<typename SpanType, typename CSpanType>
 typename SpanType::index_type find_last_not_of(SpanType s, CSpanType t)
 {
-	for(typename SpanType::index_type i = s.size(); i; --i)
-		if(std::find(t.begin(), t.end(), s[i - 1]) == t.end())
-			return i - 1;
+	auto const end = s.data() + s.size();
+	auto const pos = char_set_of(t).find_last_not_of(s.data(), end);
 
-	return -1; // s.size() ?
+	return pos == end ? -1 : typename SpanType::index_type(pos - s.data());
 }
 
 } // detail
@@ -25,6 +25,8 @@
 #include <string>
 #include <string_view>
 
+#include "split_algos.h"
+
 namespace header_only_library {
 namespace string_utils {
 
@@ -35,30 +37,43 @@ public:
 	using string_type = StringT;
 	using string_view = std::basic_string_view<CharT>;
 	using size_type = typename string_type::size_type;
+	using char_set = algorithm::basic_char_set<CharT>;
 
-	basic_string_tokenizer(string_type const& s, string_type const& delims = string_type(1, CharT(' ')))
-		: m_s(s), m_delims(delims), m_pos(m_s.find_first_not_of(m_delims)) {}
+	/**
+	 * Tokenize any contiguous text convertible to a string_view, such
+	 * as a std::string or a mapped_file. The text is not copied and
+	 * must outlive the tokenizer.
+	 */
+	basic_string_tokenizer(string_view s, string_type const& delims = string_type(1, CharT(' ')))
+		: m_s(s), m_delims(delims), m_pos(find_not(m_delims, 0)) {}
 
 	friend
 	basic_string_tokenizer& operator>>(basic_string_tokenizer& st, string_view& s)
-		{ return st.next(s, st.m_delims.c_str()); }
+		{ return st.next(s, st.m_delims); }
 
 	friend
 	basic_string_tokenizer& operator>>(basic_string_tokenizer& st, string_type& s)
 	{
 		string_view sv;
 		if(st >> sv)
-			s = sv.to_string();
+			s = string_type(sv);
 		return st;
 	}
 
 	basic_string_tokenizer& next(string_view& sv)
-		{ return next(sv, m_delims.c_str()); }
+		{ return next(sv, m_delims); }
 
 	basic_string_tokenizer& next(string_view& sv, string_type const& delims)
-		{ return next(sv, delims.c_str()); }
+		{ return next(sv, char_set(delims)); }
 
 	basic_string_tokenizer& next(string_view& sv, CharT const* delims)
+		{ return next(sv, char_set(delims)); }
+
+	/**
+	 * Delimiter sets used repeatedly are best compiled
+	 * once into a char_set and passed in here.
+	 */
+	basic_string_tokenizer& next(string_view& sv, char_set const& delims)
 	{
 		if(eot())
 		{
@@ -66,29 +81,30 @@ public:
 			return *this;
 		}
 
-		auto end = m_s.find_first_of(delims, m_pos);
+		auto const beg = m_s.data() + m_pos;
+		auto const end = delims.find_first_of(beg, m_s.data() + m_s.size());
 
-		if(end == string_type::npos)
-			end = m_s.size();
+		sv = string_view(beg, size_type(end - beg));
 
-		sv = string_view(m_s.data() + m_pos, end - m_pos);
-
-		m_pos = m_s.find_first_not_of(delims, end);
+		m_pos = find_not(delims, size_type(end - m_s.data()));
 
 		return *this;
 	}
 
 	basic_string_tokenizer& next(string_type& s)
-		{ return next(s, m_delims.c_str()); }
+		{ return next(s, m_delims); }
 
-	basic_string_tokenizer& next(string_type& s, std::string const& delims)
-		{ return next(s, delims.c_str()); }
+	basic_string_tokenizer& next(string_type& s, string_type const& delims)
+		{ return next(s, char_set(delims)); }
 
 	basic_string_tokenizer& next(string_type& s, CharT const* delims)
+		{ return next(s, char_set(delims)); }
+
+	basic_string_tokenizer& next(string_type& s, char_set const& delims)
 	{
 		string_view sv;
 		if(next(sv, delims))
-			s = sv.to_string();
+			s = string_type(sv);
 		return *this;
 	}
 
@@ -96,11 +112,18 @@ public:
 
 	explicit operator bool() const { return !done; }
 
-	void rewind() { m_pos = 0; done = false; }
+	void rewind() { m_pos = find_not(m_delims, 0); done = false; }
 
 private:
-	string_type const& m_s;
-	string_type const m_delims;
+	size_type find_not(char_set const& delims, size_type pos) const
+	{
+		auto const end = m_s.data() + m_s.size();
+		auto const p = delims.find_first_not_of(m_s.data() + pos, end);
+		return p == end ? string_type::npos : size_type(p - m_s.data());
+	}
+
+	string_view m_s;
+	char_set const m_delims;
 	size_type m_pos;
 	bool done = false;
 };
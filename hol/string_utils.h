@@ -28,17 +28,22 @@
 
 #include <algorithm>
 #include <array>
+#include <cctype>
 #include <cerrno>
 #include <codecvt>
 #include <cstdlib> // std::strtol
 #include <cstring>
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <locale>
 #include <numeric>
+#include <ostream>
 #include <regex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -51,7 +56,11 @@
 #  endif
 #endif
 
+#include "aho_corasick.h"
+#include "from_chars.h"
+#include "mapped_file.h"
 #include "split_algos.h"
+#include "unicode_case.h"
 
 //#ifdef HOL_USE_STRING_VIEW
 //#	include <string_view>
@@ -77,15 +86,49 @@ namespace string_utils {
 
 namespace detail {
 
+// Count the matches first so the result can be built in a single
+// pass into a string of exactly the right size (or, when from and to
+// are the same size, written over the original in place).
 template<typename CharT>
 std::basic_string<CharT>& replace_all_mute(
 	std::basic_string<CharT>& s,
 	const std::basic_string<CharT>& from,
 	const std::basic_string<CharT>& to)
 {
-	if(!from.empty())
-		for(std::size_t pos = 0; (pos = s.find(from, pos) + 1); pos += to.size())
-			s.replace(--pos, from.size(), to);
+	if(from.empty())
+		return s;
+
+	CharT const* const beg = s.data();
+	auto const end = beg + s.size();
+
+	std::size_t n = 0;
+	algorithm::detail::for_each_match(beg, end, from.data(), from.data() + from.size(),
+		[&](CharT const*){ ++n; });
+
+	if(!n)
+		return s;
+
+	if(from.size() == to.size())
+	{
+		algorithm::detail::for_each_match(&s[0], &s[0] + s.size(), from.data(), from.data() + from.size(),
+			[&](CharT* pos){ std::copy(std::begin(to), std::end(to), pos); });
+		return s;
+	}
+
+	std::basic_string<CharT> out;
+	out.reserve(s.size() - n * from.size() + n * to.size());
+
+	auto last = beg;
+	algorithm::detail::for_each_match(beg, end, from.data(), from.data() + from.size(),
+		[&](CharT const* pos)
+		{
+			out.append(last, pos);
+			out.append(to);
+			last = pos + from.size();
+		});
+	out.append(last, end);
+
+	s.swap(out);
 	return s;
 }
 
@@ -105,6 +148,82 @@ std::basic_string<CharT>& upper_mute(std::basic_string<CharT>& s)
 	return s;
 }
 
+// the <cctype> functions are undefined for negative char values
+template<>
+inline std::string& lower_mute(std::string& s)
+{
+	std::transform(s.begin(), s.end(), s.begin()
+		, [&](unsigned char c){ return char(std::tolower(c)); });
+	return s;
+}
+
+template<>
+inline std::string& upper_mute(std::string& s)
+{
+	std::transform(s.begin(), s.end(), s.begin()
+		, [&](unsigned char c){ return char(std::toupper(c)); });
+	return s;
+}
+
+// ASCII case mapping: flip the 0x20 bit of every byte in [lo, hi]
+
+inline void ascii_case_scalar(char* p, char* e, char lo, char hi)
+{
+	for(; p != e; ++p)
+		if(unsigned(*p - lo) <= unsigned(hi - lo))
+			*p ^= 0x20;
+}
+
+#ifdef HOL_SIMD_X86
+
+inline void ascii_case_sse2(char* p, char* e, char lo, char hi)
+{
+	auto const below = _mm_set1_epi8(char(lo - 1));
+	auto const above = _mm_set1_epi8(char(hi + 1));
+	auto const flip = _mm_set1_epi8(0x20);
+
+	for(; e - p >= 16; p += 16)
+	{
+		auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+		auto const in = _mm_and_si128(_mm_cmpgt_epi8(b, below), _mm_cmplt_epi8(b, above));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_xor_si128(b, _mm_and_si128(in, flip)));
+	}
+
+	ascii_case_scalar(p, e, lo, hi);
+}
+
+__attribute__((target("avx2")))
+inline void ascii_case_avx2(char* p, char* e, char lo, char hi)
+{
+	auto const below = _mm256_set1_epi8(char(lo - 1));
+	auto const above = _mm256_set1_epi8(char(hi + 1));
+	auto const flip = _mm256_set1_epi8(0x20);
+
+	for(; e - p >= 32; p += 32)
+	{
+		auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+		auto const in = _mm256_and_si256(_mm256_cmpgt_epi8(b, below), _mm256_cmpgt_epi8(above, b));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_xor_si256(b, _mm256_and_si256(in, flip)));
+	}
+
+	ascii_case_sse2(p, e, lo, hi);
+}
+
+#endif // HOL_SIMD_X86
+
+//! Bytes >= 0x80 compare negative so are never in range.
+inline void ascii_case(char* p, char* e, char lo, char hi)
+{
+#ifdef HOL_SIMD_X86
+	if(algorithm::detail::cpu_has_avx2())
+		ascii_case_avx2(p, e, lo, hi);
+	else
+		ascii_case_sse2(p, e, lo, hi);
+#else
+	ascii_case_scalar(p, e, lo, hi);
+#endif
+}
+
 // trim
 
 constexpr char const* ws(char) { return " \t\n\r\f\v\0"; }
@@ -112,6 +231,14 @@ constexpr wchar_t const* ws(wchar_t) { return L" \t\n\r\f\v\0"; }
 constexpr char16_t const* ws(char16_t) { return u" \t\n\r\f\v\0"; }
 constexpr char32_t const* ws(char32_t) { return U" \t\n\r\f\v\0"; }
 
+//! The default whitespace compiled once for the trim functions.
+template<typename C>
+algorithm::basic_char_set<C> const& ws_set()
+{
+	static algorithm::basic_char_set<C> const set(ws(C()));
+	return set;
+}
+
 constexpr char const* empty(char) { return ""; }
 constexpr wchar_t const* empty(wchar_t) { return L""; }
 constexpr char16_t const* empty(char16_t) { return u""; }
@@ -187,6 +314,133 @@ std::u32string replace_all_copy(std::u32string s,
 	return replace_all_mute(s, from, to);
 }
 
+//--------------------------------------------------------------
+// multiple replacements
+//
+
+/**
+ * Replaces several patterns at once. The patterns are compiled
+ * into an Aho-Corasick automaton so the cost of scanning the text
+ * does not depend on how many patterns there are.
+ *
+ * Where patterns overlap the leftmost match is replaced and, of
+ * those starting at the same place, the longest. Replacement text
+ * is never rescanned.
+ *
+ * The text is scanned once to size the result and once more
+ * to build it, so the result is allocated exactly once.
+ *
+ * Usage:
+ *
+ *	hol::replacer const escape{{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}};
+ *
+ *	auto html = escape(text);
+ */
+template<typename CharT>
+class basic_replacer
+{
+public:
+	using string_type = std::basic_string<CharT>;
+	using rule_type = std::pair<string_type, string_type>;
+
+	template<typename Iter>
+	basic_replacer(Iter beg, Iter end)
+	: m_to(make_to(beg, end)), m_ac(make_automaton(beg, end)) {}
+
+	basic_replacer(std::initializer_list<rule_type> rules)
+	: basic_replacer(std::begin(rules), std::end(rules)) {}
+
+	//! The size of the text [beg, end) after replacement.
+	std::size_t replaced_size(CharT const* beg, CharT const* end) const
+	{
+		auto size = std::size_t(end - beg);
+
+		m_ac.find_all(beg, end, [&](auto const& m){
+			size = size - m.size + m_to[m.pattern].size(); });
+
+		return size;
+	}
+
+	//! Append the text [beg, end) with replacements to out.
+	void replace_into(string_type& out, CharT const* beg, CharT const* end) const
+	{
+		out.reserve(out.size() + replaced_size(beg, end));
+
+		auto last = beg;
+		m_ac.find_all(beg, end, [&](auto const& m)
+		{
+			out.append(last, beg + m.pos);
+			out.append(m_to[m.pattern]);
+			last = beg + m.pos + m.size;
+		});
+		out.append(last, end);
+	}
+
+	string_type operator()(string_type const& s) const
+	{
+		string_type out;
+		replace_into(out, s.data(), s.data() + s.size());
+		return out;
+	}
+
+private:
+	template<typename Iter>
+	static std::vector<string_type> make_to(Iter beg, Iter end)
+	{
+		std::vector<string_type> v;
+		for(; beg != end; ++beg)
+			v.push_back(beg->second);
+		return v;
+	}
+
+	template<typename Iter>
+	static algorithm::basic_aho_corasick<CharT> make_automaton(Iter beg, Iter end)
+	{
+		std::vector<string_type> v;
+		for(; beg != end; ++beg)
+			v.push_back(beg->first);
+		return algorithm::basic_aho_corasick<CharT>(std::begin(v), std::end(v));
+	}
+
+	std::vector<string_type> m_to;
+	algorithm::basic_aho_corasick<CharT> m_ac;
+};
+
+using replacer = basic_replacer<char>;
+using wreplacer = basic_replacer<wchar_t>;
+using u16replacer = basic_replacer<char16_t>;
+using u32replacer = basic_replacer<char32_t>;
+
+template<typename CharT>
+std::basic_string<CharT>& replace_all_mute(std::basic_string<CharT>& s,
+	basic_replacer<CharT> const& r)
+{
+	auto out = r(s);
+	s.swap(out);
+	return s;
+}
+
+template<typename CharT>
+std::basic_string<CharT> replace_all_copy(std::basic_string<CharT> const& s,
+	basic_replacer<CharT> const& r)
+{
+	return r(s);
+}
+
+inline
+std::string replace_all_copy(std::string const& s,
+	std::initializer_list<std::pair<std::string, std::string>> rules)
+{
+	return replace_all_copy(s, replacer(rules));
+}
+
+inline
+std::string& replace_all_mute(std::string& s,
+	std::initializer_list<std::pair<std::string, std::string>> rules)
+{
+	return replace_all_mute(s, replacer(rules));
+}
+
 // -----------------------------------------------
 // lower_mute
 //
@@ -203,16 +457,20 @@ std::wstring& lower_mute(std::wstring& s)
 	return detail::lower_mute(s);
 }
 
+/**
+ * Unicode simple lowercase mapping (surrogate pairs
+ * are decoded, unpaired surrogates left alone).
+ */
 inline
 std::u16string& lower_mute(std::u16string& s)
 {
-	return detail::lower_mute(s);
+	return unicode_utils::to_lower_mute(s);
 }
 
 inline
 std::u32string& lower_mute(std::u32string& s)
 {
-	return detail::lower_mute(s);
+	return unicode_utils::to_lower_mute(s);
 }
 
 // -----------------------------------------------
@@ -234,13 +492,13 @@ std::wstring lower_copy(std::wstring s)
 inline
 std::u16string lower_copy(std::u16string s)
 {
-	return lower_copy(s);
+	return lower_mute(s);
 }
 
 inline
 std::u32string lower_copy(std::u32string s)
 {
-	return lower_copy(s);
+	return lower_mute(s);
 }
 
 // -----------------------------------------------
@@ -259,16 +517,20 @@ std::wstring& upper_mute(std::wstring& s)
 	return detail::upper_mute(s);
 }
 
+/**
+ * Unicode simple uppercase mapping (surrogate pairs
+ * are decoded, unpaired surrogates left alone).
+ */
 inline
 std::u16string& upper_mute(std::u16string& s)
 {
-	return detail::upper_mute(s);
+	return unicode_utils::to_upper_mute(s);
 }
 
 inline
 std::u32string& upper_mute(std::u32string& s)
 {
-	return detail::upper_mute(s);
+	return unicode_utils::to_upper_mute(s);
 }
 
 // -----------------------------------------------
@@ -299,6 +561,75 @@ std::u32string upper_copy(std::u32string s)
 	return upper_mute(s);
 }
 
+// -----------------------------------------------
+// fold_mute / fold_copy
+//
+
+/**
+ * Unicode simple case folding, for comparing or
+ * indexing strings without regard to case.
+ */
+inline
+std::u16string& fold_mute(std::u16string& s)
+{
+	return unicode_utils::fold_case_mute(s);
+}
+
+inline
+std::u32string& fold_mute(std::u32string& s)
+{
+	return unicode_utils::fold_case_mute(s);
+}
+
+inline
+std::u16string fold_copy(std::u16string s)
+{
+	return fold_mute(s);
+}
+
+inline
+std::u32string fold_copy(std::u32string s)
+{
+	return fold_mute(s);
+}
+
+// -----------------------------------------------
+// ascii_lower / ascii_upper
+//
+
+/**
+ * Lowercase only the ASCII letters, 16 or 32 bytes at a time.
+ * Unlike lower_mute() this ignores the locale and leaves every
+ * other byte, including UTF-8 sequences, alone which makes it
+ * suitable for normalising protocol keys.
+ */
+inline
+std::string& ascii_lower_mute(std::string& s)
+{
+	detail::ascii_case(&s[0], &s[0] + s.size(), 'A', 'Z');
+	return s;
+}
+
+inline
+std::string ascii_lower_copy(std::string s)
+{
+	return ascii_lower_mute(s);
+}
+
+//! Uppercase only the ASCII letters (see ascii_lower_mute()).
+inline
+std::string& ascii_upper_mute(std::string& s)
+{
+	detail::ascii_case(&s[0], &s[0] + s.size(), 'a', 'z');
+	return s;
+}
+
+inline
+std::string ascii_upper_copy(std::string s)
+{
+	return ascii_upper_mute(s);
+}
+
 /**
  * Usage:
  *
@@ -308,6 +639,10 @@ std::u32string upper_copy(std::u32string s)
  *     std::cout << sep << s;
  * std::cout << '\n';
  *
+ * When building a string prefer `out += sep; out += s;` which
+ * appends in place rather than creating a temporary string for
+ * every element (or use join_into()).
+ *
  */
 template<typename CharT>
 class basic_output_separator
@@ -320,7 +655,7 @@ public:
 	basic_output_separator(): init(detail::empty(CharT())), s(init), next(detail::space(CharT())) {}
 	basic_output_separator(CharT const* next): init(detail::empty(CharT())), s(init), next(next) {}
 	basic_output_separator(CharT const* init, CharT const* next): init(init), s(init), next(next) {}
-	basic_output_separator(basic_output_separator const& sep): s(sep.s), next(sep.next) {}
+	basic_output_separator(basic_output_separator const& sep): init(sep.init), s(sep.s), next(sep.next) {}
 
 	template<typename CharU>
 	friend std::basic_ostream<CharU>& operator<<(std::basic_ostream<CharU>& os,
@@ -331,6 +666,29 @@ public:
 		return os;
 	}
 
+	/**
+	 * Append the output_separator's current state to `s` in place
+	 * (see operator+()).
+	 *
+	 * @param s The std::string to be appended to
+	 * @param sep The output_separator object to be appended to the string.
+	 * @return A reference to `s`
+	 */
+	friend std::basic_string<CharT>& operator+=(std::basic_string<CharT>& s,
+		basic_output_separator& sep)
+	{
+		s += sep.s;
+		sep.s = sep.next;
+		return s;
+	}
+
+	//! Append to a temporary string without copying it.
+	friend std::basic_string<CharT> operator+(std::basic_string<CharT>&& s,
+		basic_output_separator& sep)
+	{
+		return std::move(s += sep);
+	}
+
 	/**
 	 * The first time this is called after construction or calling reset()
 	 * this function appends the output_separator's initial state to the string,
@@ -461,13 +819,44 @@ using String = std::basic_string<C, T, A>;
  * of the String.
  * @return The same String passed in as a parameter.
  */
+namespace detail {
+
+// These are find_first_not_of() and find_last_not_of() + 1 using
+// a compiled character set, but they return the trim points
+// rather than npos when every character is in the set.
+
 template<typename C, typename T, typename A>
-String<C, T, A>& trim_left_mute(String<C, T, A>& s, C const* ws)
+typename String<C, T, A>::size_type trim_left_pos(String<C, T, A> const& s,
+	algorithm::basic_char_set<C> const& ws)
 {
-	s.erase(0, s.find_first_not_of(ws));
+	return typename String<C, T, A>::size_type(
+		ws.find_first_not_of(s.data(), s.data() + s.size()) - s.data());
+}
+
+template<typename C, typename T, typename A>
+typename String<C, T, A>::size_type trim_right_pos(String<C, T, A> const& s,
+	algorithm::basic_char_set<C> const& ws)
+{
+	auto const end = s.data() + s.size();
+	auto const pos = ws.find_last_not_of(s.data(), end);
+	return pos == end ? 0 : typename String<C, T, A>::size_type(pos - s.data()) + 1;
+}
+
+} // namespace detail
+
+template<typename C, typename T, typename A>
+String<C, T, A>& trim_left_mute(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws)
+{
+	s.erase(0, detail::trim_left_pos(s, ws));
 	return s;
 }
 
+template<typename C, typename T, typename A>
+String<C, T, A>& trim_left_mute(String<C, T, A>& s, C const* ws)
+{
+	return trim_left_mute(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_left_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 {
@@ -477,7 +866,7 @@ String<C, T, A>& trim_left_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_left_mute(String<C, T, A>& s)
 {
-	return trim_left_mute(s, detail::ws(C()));
+	return trim_left_mute(s, detail::ws_set<C>());
 }
 
 /**
@@ -488,12 +877,18 @@ String<C, T, A>& trim_left_mute(String<C, T, A>& s)
  * @return The same String passed in as a parameter.
  */
 template<typename C, typename T, typename A>
-String<C, T, A>& trim_right_mute(String<C, T, A>& s, C const* ws)
+String<C, T, A>& trim_right_mute(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws)
 {
-	s.erase(s.find_last_not_of(ws) + 1);
+	s.erase(detail::trim_right_pos(s, ws));
 	return s;
 }
 
+template<typename C, typename T, typename A>
+String<C, T, A>& trim_right_mute(String<C, T, A>& s, C const* ws)
+{
+	return trim_right_mute(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_right_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 {
@@ -503,7 +898,7 @@ String<C, T, A>& trim_right_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_right_mute(String<C, T, A>& s)
 {
-	return trim_right_mute(s, detail::ws(C()));
+	return trim_right_mute(s, detail::ws_set<C>());
 }
 
 /**
@@ -514,11 +909,17 @@ String<C, T, A>& trim_right_mute(String<C, T, A>& s)
  * @return The same String passed in as a parameter.
  */
 template<typename C, typename T, typename A>
-String<C, T, A>& trim_mute(String<C, T, A>& s, C const* ws)
+String<C, T, A>& trim_mute(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws)
 {
 	return trim_left_mute(trim_right_mute(s, ws), ws);
 }
 
+template<typename C, typename T, typename A>
+String<C, T, A>& trim_mute(String<C, T, A>& s, C const* ws)
+{
+	return trim_mute(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 {
@@ -528,7 +929,7 @@ String<C, T, A>& trim_mute(String<C, T, A>& s, String<C, T, A> const& ws)
 template<typename C, typename T, typename A>
 String<C, T, A>& trim_mute(String<C, T, A>& s)
 {
-	return trim_mute(s, detail::ws(C()));
+	return trim_mute(s, detail::ws_set<C>());
 }
 
 //---------------------------------------------------------
@@ -543,21 +944,27 @@ String<C, T, A>& trim_mute(String<C, T, A>& s)
  * @return A copy of the string passed in as a parameter.
  */
 template<typename C, typename T, typename A>
-String<C, T, A> trim_left_copy(String<C, T, A> s, C const* ws)
+String<C, T, A> trim_left_copy(String<C, T, A> const& s, algorithm::basic_char_set<C> const& ws)
+{
+	return s.substr(detail::trim_left_pos(s, ws));
+}
+
+template<typename C, typename T, typename A>
+String<C, T, A> trim_left_copy(String<C, T, A> const& s, C const* ws)
 {
-	return trim_left_mute(s, ws);
+	return trim_left_copy(s, algorithm::basic_char_set<C>(ws));
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A> trim_left_copy(String<C, T, A> s, String<C, T, A> const& ws)
+String<C, T, A> trim_left_copy(String<C, T, A> const& s, String<C, T, A> const& ws)
 {
-	return trim_left_mute(s, ws);
+	return trim_left_copy(s, ws.c_str());
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A>& trim_left_copy(String<C, T, A> s)
+String<C, T, A> trim_left_copy(String<C, T, A> const& s)
 {
-	return trim_left_mute(s);
+	return trim_left_copy(s, detail::ws_set<C>());
 }
 
 /**
@@ -568,21 +975,27 @@ String<C, T, A>& trim_left_copy(String<C, T, A> s)
  * @return A copy of the string passed in as a parameter.
  */
 template<typename C, typename T, typename A>
-String<C, T, A> trim_right_copy(String<C, T, A> s, C const* ws)
+String<C, T, A> trim_right_copy(String<C, T, A> const& s, algorithm::basic_char_set<C> const& ws)
 {
-	return trim_right_mute(s, ws);
+	return s.substr(0, detail::trim_right_pos(s, ws));
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A> trim_right_copy(String<C, T, A> s, String<C, T, A> const& ws)
+String<C, T, A> trim_right_copy(String<C, T, A> const& s, C const* ws)
 {
-	return trim_right_mute(s, ws);
+	return trim_right_copy(s, algorithm::basic_char_set<C>(ws));
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A> trim_right_copy(String<C, T, A> s)
+String<C, T, A> trim_right_copy(String<C, T, A> const& s, String<C, T, A> const& ws)
 {
-	return trim_right_mute(s);
+	return trim_right_copy(s, ws.c_str());
+}
+
+template<typename C, typename T, typename A>
+String<C, T, A> trim_right_copy(String<C, T, A> const& s)
+{
+	return trim_right_copy(s, detail::ws_set<C>());
 }
 
 /**
@@ -593,21 +1006,33 @@ String<C, T, A> trim_right_copy(String<C, T, A> s)
  * @return A copy of the String passed in as a parameter.
  */
 template<typename C, typename T, typename A>
-String<C, T, A> trim_copy(String<C, T, A> s, C const* ws)
+String<C, T, A> trim_copy(String<C, T, A> const& s, algorithm::basic_char_set<C> const& ws)
+{
+	auto const end = detail::trim_right_pos(s, ws);
+
+	if(!end)
+		return {};
+
+	auto const pos = detail::trim_left_pos(s, ws);
+	return s.substr(pos, end - pos);
+}
+
+template<typename C, typename T, typename A>
+String<C, T, A> trim_copy(String<C, T, A> const& s, C const* ws)
 {
-	return trim_mute(s, ws);
+	return trim_copy(s, algorithm::basic_char_set<C>(ws));
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A> trim_copy(String<C, T, A> s, String<C, T, A> const& ws)
+String<C, T, A> trim_copy(String<C, T, A> const& s, String<C, T, A> const& ws)
 {
-	return trim_mute(s, ws);
+	return trim_copy(s, ws.c_str());
 }
 
 template<typename C, typename T, typename A>
-String<C, T, A> trim_copy(String<C, T, A> s)
+String<C, T, A> trim_copy(String<C, T, A> const& s)
 {
-	return trim_mute(s);
+	return trim_copy(s, detail::ws_set<C>());
 }
 
 // const char* versions
@@ -662,14 +1087,20 @@ String<C, std::char_traits<C>, std::allocator<C>> trim_copy(C const* s, C const*
  * @return The String of characters that were removed.
  */
 template<typename C, typename T, typename A>
-String<C, T, A> trim_left_keep(String<C, T, A>& s, C const* ws)
+String<C, T, A> trim_left_keep(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws)
 {
-	typename String<C, T, A>::size_type pos;
-	String<C, T, A> keep = s.substr(0, (pos = s.find_first_not_of(ws)));
+	auto const pos = detail::trim_left_pos(s, ws);
+	String<C, T, A> keep = s.substr(0, pos);
 	s.erase(0, pos);
 	return keep;
 }
 
+template<typename C, typename T, typename A>
+String<C, T, A> trim_left_keep(String<C, T, A>& s, C const* ws)
+{
+	return trim_left_keep(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 String<C, T, A> trim_left_keep(String<C, T, A>& s, String<C, T, A> const& ws)
 {
@@ -679,7 +1110,7 @@ String<C, T, A> trim_left_keep(String<C, T, A>& s, String<C, T, A> const& ws)
 template<typename C, typename T, typename A>
 String<C, T, A> trim_left_keep(String<C, T, A>& s)
 {
-	return trim_left_keep(s, detail::ws(C()));
+	return trim_left_keep(s, detail::ws_set<C>());
 }
 
 /**
@@ -690,14 +1121,20 @@ String<C, T, A> trim_left_keep(String<C, T, A>& s)
  * @return The String of characters that were removed.
  */
 template<typename C, typename T, typename A>
-String<C, T, A> trim_right_keep(String<C, T, A>& s, C const* ws)
+String<C, T, A> trim_right_keep(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws)
 {
-	typename String<C, T, A>::size_type pos;
-	String<C, T, A> keep = s.substr((pos = s.find_last_not_of(ws) + 1));
+	auto const pos = detail::trim_right_pos(s, ws);
+	String<C, T, A> keep = s.substr(pos);
 	s.erase(pos);
 	return keep;
 }
 
+template<typename C, typename T, typename A>
+String<C, T, A> trim_right_keep(String<C, T, A>& s, C const* ws)
+{
+	return trim_right_keep(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 String<C, T, A> trim_right_keep(String<C, T, A>& s, String<C, T, A> const& ws)
 {
@@ -707,7 +1144,7 @@ String<C, T, A> trim_right_keep(String<C, T, A>& s, String<C, T, A> const& ws)
 template<typename C, typename T, typename A>
 String<C, T, A> trim_right_keep(String<C, T, A>& s)
 {
-	return trim_right_keep(s, detail::ws(C()));
+	return trim_right_keep(s, detail::ws_set<C>());
 }
 
 /**
@@ -729,11 +1166,17 @@ struct rv
 } // namespace detail
 
 template<typename C, typename T, typename A>
-auto trim_keep(String<C, T, A>& s, C const* ws) -> detail::rv<C, T, A>
+auto trim_keep(String<C, T, A>& s, algorithm::basic_char_set<C> const& ws) -> detail::rv<C, T, A>
 {
 	return detail::rv<C, T, A>{trim_left_keep(s, ws), trim_right_keep(s, ws)};
 }
 
+template<typename C, typename T, typename A>
+auto trim_keep(String<C, T, A>& s, C const* ws) -> detail::rv<C, T, A>
+{
+	return trim_keep(s, algorithm::basic_char_set<C>(ws));
+}
+
 template<typename C, typename T, typename A>
 auto trim_keep(String<C, T, A>& s, String<C, T, A> const& ws) -> detail::rv<C, T, A>
 {
@@ -743,7 +1186,7 @@ auto trim_keep(String<C, T, A>& s, String<C, T, A> const& ws) -> detail::rv<C, T
 template<typename C, typename T, typename A>
 auto trim_keep(String<C, T, A>& s) -> detail::rv<C, T, A>
 {
-	return trim_keep(s, detail::ws(C()));
+	return trim_keep(s, detail::ws_set<C>());
 }
 
 ////---------------------------------------------------------
@@ -1359,67 +1802,233 @@ std::vector<std::basic_string<CharT, Traits, Alloc>> split_fold(
 		CharT const(&t)[N])
 			{ return split_fold(s, std::basic_string<CharT, Traits, Alloc>(t)); }
 
+/**
+ * Split a string wherever any of the characters in delims occurs.
+ *
+ * @param s The string that is to be divided into pieces.
+ * @param delims The set of delimiting characters.
+ * @return A std::vector containing all the pieces.
+ */
+template<typename CharT, typename Traits, typename Alloc>
+std::vector<std::basic_string<CharT, Traits, Alloc>> split_from(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		algorithm::basic_char_set<CharT> const& delims)
+{
+	std::vector<std::basic_string<CharT, Traits, Alloc>> v;
+	algorithm::split_from(std::begin(s), std::end(s), delims, algorithm::inserter(v));
+	return v;
+}
+
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+std::vector<std::basic_string<CharT, Traits, Alloc>> split_from(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		CharT const(&delims)[N])
+			{ return split_from(s, algorithm::basic_char_set<CharT>(delims)); }
+
+/**
+ * Like split_from() but adjacent delimiters produce
+ * no empty pieces.
+ */
+template<typename CharT, typename Traits, typename Alloc>
+std::vector<std::basic_string<CharT, Traits, Alloc>> split_from_fold(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		algorithm::basic_char_set<CharT> const& delims)
+{
+	std::vector<std::basic_string<CharT, Traits, Alloc>> v;
+	algorithm::split_from_fold(std::begin(s), std::end(s), delims, algorithm::inserter(v));
+	return v;
+}
+
+template<typename CharT, typename Traits, typename Alloc, std::size_t N>
+std::vector<std::basic_string<CharT, Traits, Alloc>> split_from_fold(
+	std::basic_string<CharT, Traits, Alloc> const& s,
+		CharT const(&delims)[N])
+			{ return split_from_fold(s, algorithm::basic_char_set<CharT>(delims)); }
+
 // JOIN ===========================================================================================
 
-template<typename Iter,
-	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
-String<C, T, A> join(Iter begin, Iter end, String<C, T, A> const& delim)
+namespace detail {
+
+// join pieces may be anything with data() and size() (strings,
+// string views, ranges), null terminated strings or single characters
+
+template<typename CharT>
+CharT const* join_data(CharT const* s) { return s; }
+
+template<typename CharT>
+std::size_t join_size(CharT const* s) { return std::char_traits<CharT>::length(s); }
+
+template<typename CharT>
+typename std::enable_if<std::is_integral<CharT>::value, CharT const*>::type
+join_data(CharT const& c) { return &c; }
+
+template<typename CharT>
+typename std::enable_if<std::is_integral<CharT>::value, std::size_t>::type
+join_size(CharT const&) { return 1; }
+
+template<typename Piece>
+auto join_data(Piece const& s) -> decltype(s.data()) { return s.data(); }
+
+template<typename Piece>
+auto join_size(Piece const& s) -> decltype(std::size_t(s.size())) { return s.size(); }
+
+// single pass, so grow as we go
+template<typename C, typename T, typename A, typename Iter, typename Delim>
+void join_append(std::basic_string<C, T, A>& out,
+	Iter beg, Iter end, Delim const& delim, std::input_iterator_tag)
 {
-	auto dist = std::distance(begin, end);
+	if(beg == end)
+		return;
 
-	if(!dist)
-		return {};
+	auto const d = join_data(delim);
+	auto const n = join_size(delim);
 
-	auto size = ((dist - 1) * delim.size());
+	out.append(join_data(*beg), join_size(*beg));
+	for(++beg; beg != end; ++beg)
+	{
+		out.append(d, n);
+		out.append(join_data(*beg), join_size(*beg));
+	}
+}
 
-	size += std::accumulate(begin, end, std::size_t(0),
-		[](std::size_t n, decltype(*begin) const& s){ return n + s.size(); });
+// measure first then copy into the exact sized result
+template<typename C, typename T, typename A, typename Iter, typename Delim>
+void join_append(std::basic_string<C, T, A>& out,
+	Iter beg, Iter end, Delim const& delim, std::forward_iterator_tag)
+{
+	if(beg == end)
+		return;
 
-	String<C, T, A> s;
-	s.reserve(size);
+	auto const d = join_data(delim);
+	auto const n = join_size(delim);
 
-	if(begin != end)
-		s = *begin;
+	std::size_t size = join_size(*beg);
+	for(auto i = std::next(beg); i != end; ++i)
+		size += n + join_size(*i);
 
-	for(++begin; begin != end; ++begin)
-		s.append(delim).append(*begin);
+	auto const pos = out.size();
+	out.resize(pos + size);
+	auto p = &out[pos];
 
-	return s;
+	auto const piece = [&p](Iter i)
+	{
+		auto const size = join_size(*i);
+		T::copy(p, join_data(*i), size);
+		p += size;
+	};
+
+	piece(beg);
+	for(++beg; beg != end; ++beg)
+	{
+		T::copy(p, d, n);
+		p += n;
+		piece(beg);
+	}
+}
+
+} // namespace detail
+
+/**
+ * Append the pieces in the range [beg, end) to `out`, separated
+ * by `delim`. For forward iterators the exact final size is measured
+ * up front so `out` is allocated at most once, and a buffer reused
+ * between calls is not reallocated at all once it is big enough.
+ *
+ * The pieces and the delimiter can be strings, string views, ranges,
+ * null terminated strings or single characters.
+ *
+ * @param out The string to append to.
+ * @param beg The beginning of the range of pieces.
+ * @param end The end of the range of pieces.
+ * @param delim The separator to place between pieces.
+ * @return A reference to `out`.
+ */
+template<typename C, typename T, typename A, typename Iter, typename Delim>
+std::basic_string<C, T, A>& join_into(std::basic_string<C, T, A>& out,
+	Iter beg, Iter end, Delim const& delim)
+{
+	detail::join_append(out, beg, end, delim,
+		typename std::iterator_traits<Iter>::iterator_category());
+	return out;
+}
+
+/**
+ * Write the pieces in the range [beg, end) to `os`, separated
+ * by `delim`, without building any intermediate string.
+ *
+ * @param os The stream to write to.
+ * @param beg The beginning of the range of pieces.
+ * @param end The end of the range of pieces.
+ * @param delim The separator to place between pieces.
+ * @return A reference to `os`.
+ */
+template<typename C, typename T, typename Iter, typename Delim>
+std::basic_ostream<C, T>& join_into(std::basic_ostream<C, T>& os,
+	Iter beg, Iter end, Delim const& delim)
+{
+	if(beg == end)
+		return os;
+
+	auto const d = detail::join_data(delim);
+	auto const n = detail::join_size(delim);
+
+	os.write(detail::join_data(*beg), detail::join_size(*beg));
+	for(++beg; beg != end; ++beg)
+	{
+		os.write(d, n);
+		os.write(detail::join_data(*beg), detail::join_size(*beg));
+	}
+
+	return os;
+}
+
+template<typename Out, typename Range, typename Delim>
+auto join_into(Out& out, Range const& r, Delim const& delim)
+	-> decltype(join_into(out, std::begin(r), std::end(r), delim))
+		{ return join_into(out, std::begin(r), std::end(r), delim); }
+
+template<typename Iter,
+	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
+String<C, T, A> join(Iter begin, Iter end, String<C, T, A> const& delim)
+{
+	String<C, T, A> s;
+	return join_into(s, begin, end, delim);
 }
 
 template<typename Iter,
 	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
 String<C, T, A> join(Iter begin, Iter end, C const* delim)
 {
-	return join(begin, end, String<C, T, A>(delim));
+	String<C, T, A> s;
+	return join_into(s, begin, end, delim);
 }
 
 template<typename Iter,
 	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
 String<C, T, A> join(Iter begin, Iter end)
 {
-	return join(begin, end, String<C, T, A>(detail::empty(C())));
+	return join(begin, end, detail::empty(C()));
 }
 
 //
 
-template<template<class> class Container,
-	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
-String<C, T, A> join(Container<String<C, T, A>> const& c, String<C, T, A> const& delim)
+template<template<class...> class Container,
+	typename C, typename T, typename A, typename... Rest>
+String<C, T, A> join(Container<String<C, T, A>, Rest...> const& c, String<C, T, A> const& delim)
 {
 	return join(std::begin(c), std::end(c), delim);
 }
 
-template<template<class> class Container,
-	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
-String<C, T, A> join(Container<String<C, T, A>> const& c, C const* delim)
+template<template<class...> class Container,
+	typename C, typename T, typename A, typename... Rest>
+String<C, T, A> join(Container<String<C, T, A>, Rest...> const& c, C const* delim)
 {
 	return join(c, String<C, T, A>(delim));
 }
 
-template<template<class> class Container,
-	typename C, typename T = std::char_traits<C>, typename A = std::allocator<C>>
-String<C, T, A> join(Container<String<C, T, A>> const& c)
+template<template<class...> class Container,
+	typename C, typename T, typename A, typename... Rest>
+String<C, T, A> join(Container<String<C, T, A>, Rest...> const& c)
 {
 	return join(c, String<C, T, A>(detail::empty(C())));
 }
@@ -1440,8 +2049,6 @@ String<C, T, A> join(Container<String<C, T, A>> const& c)
 //bool s_to_ul(const std::string& s, unsigned long& ul);
 //bool s_to_ull(const std::string& s, unsigned long long& ull);
 //
-//bool s_to_f(const std::string& s, float& f);
-//bool s_to_d(const std::string& s, double& d);
 //bool s_to_ld(const std::string& s, long double& ld);
 
 // string conversions
@@ -1460,79 +2067,106 @@ bool s_to_test(char const* s, char const* e)
 	return !(*e);
 }
 
+//! Parse like std::strtol() then allow nothing but trailing whitespace.
+template<typename Integer>
+bool s_to_integer(std::string const& s, Integer& i, int base)
+{
+	auto const end = s.data() + s.size();
+
+	Integer n;
+	auto const r = string_conversions::scan_integer(s.data(), end, n, base);
+
+	if(r.ec != std::errc()
+	|| !std::all_of(r.ptr, end, [](char c){ return string_conversions::detail::is_space(c); }))
+		return false;
+
+	i = n;
+	return true;
+}
+
 } // namespace detail
 
+/**
+ * Convert a whole string to a signed integer. The input is the same
+ * as std::strtol() accepts, optionally followed by whitespace.
+ *
+ * @param s The string to convert.
+ * @param i Converted output. ONLY set if conversion succeeds.
+ * @param base The number base, 0 or from 2 to 36.
+ * @return true if `s` holds a number that fits in `i`.
+ */
 template<typename Signed>
 bool s_to_i(const std::string& s, Signed& i, int base = 10)
 {
 	static_assert(std::is_integral<Signed>::value, "s_to_i() requires an integral output value");
 	static_assert(std::is_signed<Signed>::value, "s_to_i() requires a signed output value, did you mean s_to_u()?");
 
-	char* end;
-	auto l = std::strtoll(s.c_str(), &end, base);
-
-	if(l > std::numeric_limits<Signed>::max()
-	|| l < std::numeric_limits<Signed>::min())
-		return false;
-
-	if(!detail::s_to_test(s.c_str(), end))
-		return false;
-
-	i = static_cast<Signed>(l);
-
-	return true;
+	return detail::s_to_integer(s, i, base);
 }
 
+//! Convert a whole string to an unsigned integer (see s_to_i()).
 template<typename Unsigned>
 bool s_to_u(const std::string& s, Unsigned& i, int base = 10)
 {
 	static_assert(std::is_integral<Unsigned>::value, "s_to_u() requires an integral output value");
 	static_assert(std::is_unsigned<Unsigned>::value, "s_to_u() requires an unsigned output value, did you mean s_to_i()?");
 
-	char* end;
-	auto l = std::strtoull(s.c_str(), &end, base);
+	return detail::s_to_integer(s, i, base);
+}
 
-	if(l > std::numeric_limits<Unsigned>::max())
-		return false;
+namespace detail {
 
-	if(!detail::s_to_test(s.c_str(), end))
-		return false;
+template<typename Real>
+bool s_to_real(std::string const& s, Real& r)
+{
+	auto const end = s.data() + s.size();
+
+	Real n;
+	auto const res = string_conversions::scan_real(s.data(), end, n);
 
-	i = static_cast<Unsigned>(l);
+	if(res.ec != std::errc()
+	|| !std::all_of(res.ptr, end, [](char c){ return string_conversions::detail::is_space(c); }))
+		return false;
 
+	r = n;
 	return true;
 }
 
+} // namespace detail
+
+/**
+ * Convert a whole string to a float, correctly rounded and
+ * independent of the locale. The input is what std::strtof()
+ * accepts (except hexadecimal), optionally followed by whitespace.
+ *
+ * @param s The string to convert.
+ * @param f Converted output. ONLY set if conversion succeeds.
+ * @return true if `s` holds a number in range for a float.
+ */
 inline
-bool s_to_i(const std::string& s, long int& l)
-{
-	char* end;
-	l = std::strtol(s.c_str(), &end, 10);
-	return detail::s_to_test(s.c_str(), end);
-}
+bool s_to_f(std::string const& s, float& f) { return detail::s_to_real(s, f); }
 
+//! Convert a whole string to a double (see s_to_f()).
 inline
-bool s_to_i(const std::string& s, long long int& ll)
-{
-	char* end;
-	ll = std::strtoll(s.c_str(), &end, 10);
-	return detail::s_to_test(s.c_str(), end);
-}
+bool s_to_d(std::string const& s, double& d) { return detail::s_to_real(s, d); }
 
+/**
+ * The shortest text that s_to_d() converts back to exactly `d`,
+ * with no dependence on the locale. Use string_conversions::to_chars()
+ * to write into an existing buffer.
+ */
 inline
-bool s_to_u(const std::string& s, unsigned long int& ul)
+std::string r_to_s(double d)
 {
-	char* end;
-	ul = std::strtoul(s.c_str(), &end, 10);
-	return detail::s_to_test(s.c_str(), end);
+	char buf[32];
+	return {buf, string_conversions::to_chars(buf, buf + sizeof(buf), d).ptr};
 }
 
 inline
-bool s_to_u(const std::string& s, unsigned long long int& ull)
+std::string r_to_s(float f)
 {
-	char* end;
-	ull = std::strtoull(s.c_str(), &end, 10);
-	return detail::s_to_test(s.c_str(), end);
+	char buf[32];
+	return {buf, string_conversions::to_chars(buf, buf + sizeof(buf), f).ptr};
 }
 
 //inline
@@ -1568,22 +2202,6 @@ bool s_to_u(const std::string& s, unsigned long long int& ull)
 //}
 //
 //inline
-//bool s_to_f(const std::string& s, float& f)
-//{
-//	char* end;
-//	f = std::strtof(s.c_str(), &end);
-//	return detail::s_to_test(s.c_str(), end);
-//}
-//
-//inline
-//bool s_to_d(const std::string& s, double& d)
-//{
-//	char* end;
-//	d = std::strtod(s.c_str(), &end);
-//	return detail::s_to_test(s.c_str(), end);
-//}
-//
-//inline
 //bool s_to_ld(const std::string& s, long double& ld)
 //{
 //	char* end;
@@ -1630,6 +2248,21 @@ std::string load_file(std::string const& filepath)
 	return load_file_as<std::string>(filepath);
 }
 
+#ifdef __unix__
+
+/**
+ * Memory map a file rather than reading it into memory. Its contents
+ * are available through mapped_file::as_range(), as_srange() and (in
+ * C++17) as_string_view() without any copying.
+ */
+inline
+mapped_file load_file_mapped(std::string const& filepath, unsigned advice = mapped_file::sequential)
+{
+	return mapped_file(filepath, advice);
+}
+
+#endif // __unix__
+
 #ifdef HOL_HAS_STD_BYTE
 
 inline
@@ -1700,45 +2333,103 @@ std::istream& getline(std::istream& is, std::string& s, std::streamsize num, cha
 	ms.create(d, std::cout);
 	std::cout << '\n';
 
-	ms.preallocate(d);
 	auto s = ms.create(d);
+
+	// fastest: values indexed by slot, resolved once
+	std::vector<std::string> values(ms.slot_count());
+	values[ms.slot("${a}")] = "A";
+	values[ms.slot("${b}")] = "Beeeef";
+	values[ms.slot("${c}")] = "C";
+
+	std::string buf;
+	ms.render_into(buf, values);
  *
  */
 class mapped_stencil
 {
-	struct place
-	{
-		using set = std::set<place>;
-		using vec = std::vector<place>;
+public:
+	using dict = std::unordered_map<std::string, std::string>;
 
-		char const* pos;
+private:
+	// literal text[pos, pos + len) followed by the value of
+	// variable `slot` (std::string::npos after the final piece)
+	struct piece
+	{
+		std::size_t pos;
 		std::size_t len;
-
-		place(char const* pos, std::size_t len): pos(pos), len(len) {}
-
-		bool operator<(place const& other) const { return pos < other.pos; }
+		std::size_t slot;
 	};
 
-	// order: piece, var, piece, var, piece
-	place::vec vars;
+	std::vector<piece> pieces;
+	std::vector<std::string> names;
+	std::vector<std::size_t> counts; // occurrences of each slot
 	std::string text;
-	std::ptrdiff_t diff = 0;
+	std::size_t literal_size = 0;
 
-public:
-	using dict = std::unordered_map<std::string, std::string>;
+	template<typename Values>
+	std::size_t measure(Values const& values) const
+	{
+		auto n = literal_size;
+		for(std::size_t i = 0; i < counts.size(); ++i)
+			n += counts[i] * detail::join_size(values[i]);
+		return n;
+	}
+
+	template<typename Values>
+	void write(char* out, Values const& values) const
+	{
+		for(auto const& p: pieces)
+		{
+			std::char_traits<char>::copy(out, text.data() + p.pos, p.len);
+			out += p.len;
+
+			if(p.slot == std::string::npos)
+				break;
+
+			auto const n = detail::join_size(values[p.slot]);
+			std::char_traits<char>::copy(out, detail::join_data(values[p.slot]), n);
+			out += n;
+		}
+	}
+
+	// the dictionary entry of every slot, or an empty string
+	std::vector<std::string const*> bind(dict const& d) const
+	{
+		static std::string const none;
+		std::vector<std::string const*> bound(names.size(), &none);
+
+		for(std::size_t i = 0; i < names.size(); ++i)
+		{
+			auto found = d.find(names[i]);
+			if(found != d.end())
+				bound[i] = &found->second;
+		}
 
+		return bound;
+	}
+
+	struct deref
+	{
+		std::vector<std::string const*> const& v;
+		std::string const& operator[](std::size_t i) const { return *v[i]; }
+	};
+
+public:
 	/**
 	 * Create an empty stencil
 	 */
 	mapped_stencil() {}
-	mapped_stencil(mapped_stencil&& s): vars(std::move(s.vars)), text(std::move(s.text)) {}
-	mapped_stencil(const mapped_stencil& s): vars(s.vars), text(s.text) {}
-
-	mapped_stencil& operator=(mapped_stencil&& s) { vars = std::move(s.vars); text = std::move(s.text); return *this; }
-	mapped_stencil& operator=(mapped_stencil const& s) { vars = s.vars; text = s.text; return *this; }
 
-	void clear() { vars.clear(); text.clear(); diff = 0; }
+	void clear() { pieces.clear(); names.clear(); counts.clear(); text.clear(); literal_size = 0; }
 
+	/**
+	 * Find every occurrence of each variable name in `text` and assign
+	 * each distinct name a slot (in the order of `vars`). Where matches
+	 * overlap the earliest wins, then the longest.
+	 *
+	 * @param text The template text.
+	 * @param vars The variable names, including any delimiters such as `${}`.
+	 */
 	template<typename Container>
 	void compile(std::string const& text, Container const& vars)
 	{
@@ -1747,91 +2438,112 @@ public:
 		this->text = text;
 
 		for(auto&& v: vars)
-			for(auto pos = 0ULL; (pos = text.find(v, pos)) != std::string::npos; pos += v.size())
-				this->vars.emplace_back(this->text.data() + pos, v.size());
+		{
+			std::string name(v);
 
-		std::sort(std::begin(this->vars), std::end(this->vars));
+			if(!name.empty() && std::find(names.begin(), names.end(), name) == names.end())
+				names.push_back(std::move(name));
+		}
 
-		diff = text.size();
-	}
+		counts.assign(names.size(), 0);
 
-	void create(dict const& d, std::ostream& os) const
-	{
-		auto pos = text.data();
+		// one pass finds every variable (pattern indexes are slots)
+		algorithm::aho_corasick const ac(names.begin(), names.end());
 
-		for(auto const& v: vars)
+		std::size_t pos = 0;
+		ac.find_all(this->text, [&](algorithm::aho_corasick::match const& m)
 		{
-			if(v.pos > pos)
-				os.write(pos, v.pos - pos);
-
-			auto found = d.find({v.pos, v.len});
+			pieces.push_back({pos, m.pos - pos, m.pattern});
+			literal_size += m.pos - pos;
+			++counts[m.pattern];
+			pos = m.pos + m.size;
+		});
+
+		pieces.push_back({pos, text.size() - pos, std::string::npos});
+		literal_size += text.size() - pos;
+	}
 
-			if(found != d.end())
-				os.write(found->second.data(), found->second.size());
+	//! The number of distinct variables.
+	std::size_t slot_count() const { return names.size(); }
 
-			pos = v.pos + v.len;
-		}
-
-		if(pos < text.data() + text.size())
-			os.write(pos, text.size());
+	//! The slot of variable `name` or std::string::npos if it was not compiled.
+	std::size_t slot(std::string const& name) const
+	{
+		auto found = std::find(names.begin(), names.end(), name);
+		return found == names.end() ? std::string::npos : std::size_t(found - names.begin());
 	}
 
 	/**
-	 * Call preallocate() before calling `std::string create(dict const& d)`
-	 * in order to set the internal string allocation size to exactly match
-	 * the created string (rather than using an estimation).
-	 *
-	 * This function only needs to be caled once every time the dictionary `dict`
-	 * changes.
+	 * The exact length of the text render() would produce.
 	 *
-	 * @param d The `dict` that will be used when calling the `create()` function.
+	 * @param values The value of each variable indexed by its slot.
+	 * Each value may be a string, string view, range or null terminated string.
 	 */
-	void preallocate(dict const& d)
-	{
-		for(auto const& v: vars)
-		{
-			auto found = d.find({v.pos, v.len});
-			if(found == d.end())
-				continue;
-
-			diff -= found->first.size();
-			diff += found->second.size();
-		}
-	}
+	template<typename Values>
+	std::size_t size(Values const& values) const { return measure(values); }
 
 	/**
-	 * Call preallocate first to obtain exact string allocation.
-	 * Call preallocate only needed when `dict`changes.
-	 * @param d
-	 * @return
+	 * Append the rendered text to `out`. The output is measured first
+	 * so `out` grows at most once, and not at all when a buffer reused
+	 * between calls is already big enough. No hashing is done.
+	 *
+	 * @param out The string to append to.
+	 * @param values The value of each variable indexed by its slot.
+	 * @return A reference to `out`.
 	 */
-	std::string create(dict const& d) const
+	template<typename Values>
+	std::string& render_into(std::string& out, Values const& values) const
 	{
-		if(vars.empty())
-			return text;
+		auto const size = out.size();
+		out.resize(size + measure(values));
+		write(&out[0] + size, values);
+		return out;
+	}
 
+	template<typename Values>
+	std::string render(Values const& values) const
+	{
 		std::string out;
-		out.reserve(text.size() + diff);
-
-		auto pos = text.data();
+		render_into(out, values);
+		return out;
+	}
 
-		for(auto const& v: vars)
+	template<typename Values>
+	void render(Values const& values, std::ostream& os) const
+	{
+		for(auto const& p: pieces)
 		{
-			if(v.pos > pos)
-				out.append(pos, v.pos);
+			os.write(text.data() + p.pos, std::streamsize(p.len));
 
-			auto found = d.find({v.pos, v.len});
+			if(p.slot == std::string::npos)
+				break;
 
-			if(found != d.end())
-				out.append(found->second);
-
-			pos = v.pos + v.len;
+			os.write(detail::join_data(values[p.slot]), std::streamsize(detail::join_size(values[p.slot])));
 		}
+	}
+
+	/**
+	 * Write the text with each variable replaced by its entry in `d`
+	 * (or removed if it has none). Each distinct variable is looked
+	 * up once per call; use render() with values indexed by slot to
+	 * avoid the lookups altogether.
+	 */
+	void create(dict const& d, std::ostream& os) const
+	{
+		auto const bound = bind(d);
+		render(deref{bound}, os);
+	}
 
-		if(pos < text.data() + text.size())
-			out.append(pos, text.size());
+	/**
+	 * The created string is always allocated at its exact size so
+	 * this is no longer needed. It is kept for compatibility.
+	 */
+	void preallocate(dict const&) {}
 
-		return out;
+	std::string create(dict const& d) const
+	{
+		auto const bound = bind(d);
+		return render(deref{bound});
 	}
 };
 
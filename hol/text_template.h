@@ -0,0 +1,580 @@
+#ifndef HEADER_ONLY_LIBRARY_TEXT_TEMPLATE_H
+#define HEADER_ONLY_LIBRARY_TEXT_TEMPLATE_H
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "macro_exceptions.h"
+
+namespace header_only_library {
+namespace string_utils {
+
+/**
+ * A template compiled to a compact vector of instructions that renders
+ * into a reusable buffer without allocating (once the buffer is big
+ * enough). Unlike mapped_stencil the variables need not be listed in
+ * advance: every placeholder is found in a single scan at compile time
+ * and given a slot, so rendering never hashes or compares names.
+ *
+ * Syntax:
+ *
+ *	${name}            the value of `name`
+ *	${name|html}       escaped with a filter: `html`, `url` or `json`
+ *	${#name}...${/name} repeated for each item added to `name`, or
+ *	                   rendered once if `name` is a true value
+ *	${?name}...${/name} rendered once if `name` is true
+ *	${!name}...${/name} rendered once if `name` is not true
+ *	${.}               the value of the current item
+ *	$${                a literal `${`
+ *
+ * A value is true when it is a non-empty string, has items or has
+ * been flagged. Names inside a section are looked up in the current
+ * item first and then in each enclosing scope.
+ *
+ * Usage:
+ *
+ *	hol::text_template t{"Hi ${name|html}:${#items} ${title}${/items}"};
+ *
+ *	hol::text_template::data d{t};
+ *	d.set("name", "Bob & Co");
+ *	d.add("items").set("title", "one");
+ *	d.add("items").set("title", "two");
+ *
+ *	std::string buf;
+ *	t.render_into(buf, d); // "Hi Bob &amp; Co: one two"
+ */
+class text_template
+{
+public:
+	enum class filter: std::uint8_t { none, html, url, json };
+
+	class data;
+
+	text_template() {}
+	explicit text_template(std::string text) { compile(std::move(text)); }
+
+	/**
+	 * Compile `text`, replacing any previous template.
+	 * Throws std::invalid_argument on a malformed tag or section.
+	 */
+	void compile(std::string text)
+	{
+		m_text = std::move(text);
+		m_code.clear();
+		m_names.clear();
+
+		if(m_text.size() > std::numeric_limits<std::uint32_t>::max())
+			hol_throw_exception(std::invalid_argument, "template too large");
+
+		std::vector<std::size_t> open; // unclosed sections
+
+		char const* const beg = m_text.data();
+		auto const end = beg + m_text.size();
+
+		std::size_t lit = 0; // start of pending literal text
+
+		for(auto p = beg; (p = find_tag(p, end)) != end;)
+		{
+			std::size_t const pos = p - beg;
+
+			if(pos && p[-1] == '$') // $${ is a literal ${
+			{
+				emit_text(lit, pos - 1);
+				lit = pos;
+				p += 2;
+				continue;
+			}
+
+			auto const close = static_cast<char const*>(std::memchr(p + 2, '}', end - p - 2));
+
+			if(!close)
+				hol_throw_exception(std::invalid_argument, "unterminated tag at " << pos);
+
+			auto tag = trim(p + 2, close);
+
+			emit_text(lit, pos);
+			lit = close + 1 - beg;
+			p = close + 1;
+
+			char sigil = 0;
+
+			if(tag.first != tag.second && *tag.first && std::strchr("#?!/", *tag.first))
+				sigil = *tag.first++;
+
+			auto const bar = std::find(tag.first, tag.second, '|');
+			auto const name = trim(tag.first, bar);
+			auto const esc = bar == tag.second ? filter::none : parse_filter(trim(bar + 1, tag.second), pos);
+
+			if(name.first == name.second)
+				hol_throw_exception(std::invalid_argument, "missing name in tag at " << pos);
+
+			if(sigil && esc != filter::none)
+				hol_throw_exception(std::invalid_argument, "filter on a section tag at " << pos);
+
+			auto const slot = slot_for(name);
+
+			if(sigil == '/')
+			{
+				if(open.empty() || m_code[open.back()].a != slot)
+					hol_throw_exception(std::invalid_argument, "unmatched section end at " << pos);
+
+				m_code[open.back()].b = std::uint32_t(m_code.size());
+				open.pop_back();
+				continue;
+			}
+
+			op const code = sigil == '#' ? op::each
+				: sigil == '?' ? op::when
+				: sigil == '!' ? op::unless
+				: op::value;
+
+			if(code != op::value)
+				open.push_back(m_code.size());
+
+			m_code.push_back({code, esc, slot, 0});
+		}
+
+		if(!open.empty())
+			hol_throw_exception(std::invalid_argument, "unclosed section: " << m_names[m_code[open.back()].a]);
+
+		emit_text(lit, m_text.size());
+	}
+
+	//! The number of distinct names in the template.
+	std::size_t slot_count() const { return m_names.size(); }
+
+	//! The slot of `name` or std::string::npos if the template does not use it.
+	std::size_t slot(std::string const& name) const
+	{
+		auto found = std::find(m_names.begin(), m_names.end(), name);
+		return found == m_names.end() ? std::string::npos : std::size_t(found - m_names.begin());
+	}
+
+	std::string const& name(std::size_t slot) const { return m_names[slot]; }
+
+	//! The number of compiled instructions.
+	std::size_t size() const { return m_code.size(); }
+
+	/**
+	 * Append the rendered text to `out`. Nothing is allocated
+	 * unless `out` needs to grow.
+	 *
+	 * @param out The string to append to.
+	 * @param d Values for this template's slots.
+	 * @return A reference to `out`.
+	 */
+	std::string& render_into(std::string& out, data const& d) const;
+
+	std::string render(data const& d) const
+	{
+		std::string out;
+		render_into(out, d);
+		return out;
+	}
+
+private:
+	enum class op: std::uint8_t { text, value, each, when, unless };
+
+	struct instr
+	{
+		op code;
+		filter escape;
+		std::uint32_t a; // text offset or slot
+		std::uint32_t b; // text length or the end of a section
+	};
+
+	using span = std::pair<char const*, char const*>;
+
+	static char const* find_tag(char const* p, char const* end)
+	{
+		while((p = static_cast<char const*>(std::memchr(p, '$', end - p))))
+		{
+			if(end - p > 1 && p[1] == '{')
+				return p;
+			++p;
+		}
+		return end;
+	}
+
+	static span trim(char const* b, char const* e)
+	{
+		while(b != e && *b == ' ')
+			++b;
+		while(e != b && e[-1] == ' ')
+			--e;
+		return {b, e};
+	}
+
+	static bool equal(span s, char const* word)
+	{
+		return std::size_t(s.second - s.first) == std::strlen(word)
+			&& std::equal(s.first, s.second, word);
+	}
+
+	static filter parse_filter(span s, std::size_t pos)
+	{
+		if(equal(s, "html"))
+			return filter::html;
+		if(equal(s, "url"))
+			return filter::url;
+		if(equal(s, "json"))
+			return filter::json;
+
+		hol_throw_exception(std::invalid_argument, "unknown filter '"
+			<< std::string(s.first, s.second) << "' at " << pos);
+
+		return filter::none;
+	}
+
+	std::uint32_t slot_for(span name)
+	{
+		std::string s(name.first, name.second);
+		auto found = std::find(m_names.begin(), m_names.end(), s);
+
+		if(found != m_names.end())
+			return std::uint32_t(found - m_names.begin());
+
+		m_names.push_back(std::move(s));
+		return std::uint32_t(m_names.size() - 1);
+	}
+
+	void emit_text(std::size_t beg, std::size_t end)
+	{
+		if(beg != end)
+			m_code.push_back({op::text, filter::none, std::uint32_t(beg), std::uint32_t(end - beg)});
+	}
+
+	static void escape(std::string& out, std::string const& s, filter f);
+
+	void run(std::size_t pc, std::size_t end, data const& d, std::uint32_t scope, std::string& out) const;
+
+	std::string m_text;
+	std::vector<instr> m_code;
+	std::vector<std::string> m_names;
+};
+
+/**
+ * The values to render a text_template with. Values are kept in one
+ * flat array per scope indexed by slot, and clear() keeps all of the
+ * memory so a `data` reused for each render stops allocating once
+ * its strings have grown large enough.
+ *
+ * The template must outlive the data and must not be recompiled.
+ */
+class text_template::data
+{
+	struct entry
+	{
+		std::string text;
+		std::vector<std::uint32_t> items; // scopes
+		bool set = false;
+		bool on = false;
+
+		bool truth() const { return on || !text.empty() || !items.empty(); }
+	};
+
+public:
+	//! A handle to the values of the top level or of one item.
+	class scope
+	{
+	public:
+		scope& set(std::size_t slot, char const* value, std::size_t n)
+		{
+			if(d && slot < d->slots)
+			{
+				auto& e = d->at(id, slot);
+				e.text.assign(value, n);
+				e.set = true;
+			}
+			return *this;
+		}
+
+		scope& set(std::size_t slot, std::string const& value)
+			{ return set(slot, value.data(), value.size()); }
+
+		scope& set(std::string const& name, std::string const& value)
+			{ return set(slot_of(name), value); }
+
+		//! Make `name` true (or false) without giving it any text.
+		scope& flag(std::size_t slot, bool on = true)
+		{
+			if(d && slot < d->slots)
+			{
+				auto& e = d->at(id, slot);
+				e.on = on;
+				e.set = true;
+			}
+			return *this;
+		}
+
+		scope& flag(std::string const& name, bool on = true)
+			{ return flag(slot_of(name), on); }
+
+		/**
+		 * Add an item to the list `name` and return its scope.
+		 * If the template does not use `name` nothing is added and
+		 * a detached scope is returned, on which every call does nothing.
+		 */
+		scope add(std::size_t slot)
+		{
+			if(!d || slot >= d->slots)
+				return {nullptr, 0};
+
+			auto const item = d->new_scope(id);
+			auto& e = d->at(id, slot);
+			e.items.push_back(item);
+			e.set = true;
+			return {d, item};
+		}
+
+		scope add(std::string const& name)
+			{ return add(slot_of(name)); }
+
+		//! Add an item whose value ${.} is `value`.
+		scope add(std::string const& name, std::string const& value)
+			{ return add(name).set(".", value); }
+
+	private:
+		friend class data;
+		scope(data* d, std::uint32_t id): d(d), id(id) {}
+
+		std::size_t slot_of(std::string const& name) const
+			{ return d ? d->tpl->slot(name) : std::string::npos; }
+
+		data* d; // null when detached
+		std::uint32_t id;
+	};
+
+	explicit data(text_template const& tpl)
+	: tpl(&tpl), slots(tpl.slot_count()), entries(slots) {}
+
+	scope root() { return {this, 0}; }
+
+	data& set(std::string const& name, std::string const& value) { root().set(name, value); return *this; }
+	data& flag(std::string const& name, bool on = true) { root().flag(name, on); return *this; }
+	scope add(std::string const& name) { return root().add(name); }
+	scope add(std::string const& name, std::string const& value) { return root().add(name, value); }
+
+	//! Forget every value but keep the memory for reuse.
+	void clear()
+	{
+		for(std::size_t i = 0; i < scopes * slots; ++i)
+		{
+			entries[i].text.clear();
+			entries[i].items.clear();
+			entries[i].set = false;
+			entries[i].on = false;
+		}
+		parents.resize(1);
+		scopes = 1;
+	}
+
+private:
+	friend class text_template;
+
+	entry& at(std::uint32_t scope, std::size_t slot) { return entries[scope * slots + slot]; }
+
+	std::uint32_t new_scope(std::uint32_t parent)
+	{
+		if(entries.size() < (scopes + 1) * slots)
+			entries.resize((scopes + 1) * slots);
+
+		parents.push_back(parent);
+		return std::uint32_t(scopes++);
+	}
+
+	//! The innermost value of `slot` visible from `scope`.
+	entry const* find(std::uint32_t scope, std::size_t slot) const
+	{
+		for(;;)
+		{
+			auto const& e = entries[scope * slots + slot];
+
+			if(e.set)
+				return &e;
+
+			if(!scope)
+				return nullptr;
+
+			scope = parents[scope];
+		}
+	}
+
+	text_template const* tpl;
+	std::size_t slots;
+	std::size_t scopes = 1;
+	std::vector<entry> entries; // scope * slots + slot
+	std::vector<std::uint32_t> parents = {0};
+};
+
+inline
+std::string& text_template::render_into(std::string& out, data const& d) const
+{
+	if(d.slots != m_names.size())
+		hol_throw_exception(std::invalid_argument, "data belongs to a different template");
+
+	run(0, m_code.size(), d, 0, out);
+	return out;
+}
+
+inline
+void text_template::run(std::size_t pc, std::size_t end, data const& d,
+	std::uint32_t scope, std::string& out) const
+{
+	while(pc < end)
+	{
+		auto const& i = m_code[pc++];
+
+		if(i.code == op::text)
+		{
+			out.append(m_text.data() + i.a, i.b);
+			continue;
+		}
+
+		auto const e = d.find(scope, i.a);
+
+		switch(i.code)
+		{
+			case op::value:
+				if(e)
+					escape(out, e->text, i.escape);
+				break;
+
+			case op::each:
+				if(e && !e->items.empty())
+					for(auto item: e->items)
+						run(pc, i.b, d, item, out);
+				else if(e && e->truth())
+					run(pc, i.b, d, scope, out);
+				pc = i.b;
+				break;
+
+			case op::when:
+				if(e && e->truth())
+					run(pc, i.b, d, scope, out);
+				pc = i.b;
+				break;
+
+			case op::unless:
+				if(!e || !e->truth())
+					run(pc, i.b, d, scope, out);
+				pc = i.b;
+				break;
+
+			case op::text:
+				break;
+		}
+	}
+}
+
+inline
+void text_template::escape(std::string& out, std::string const& s, filter f)
+{
+	if(f == filter::none)
+	{
+		out.append(s);
+		return;
+	}
+
+	static char const hex[] = "0123456789ABCDEF";
+
+	auto run = s.data(); // the start of unescaped characters
+	auto const end = s.data() + s.size();
+
+	for(auto p = run; p != end; ++p)
+	{
+		auto const c = static_cast<unsigned char>(*p);
+		char const* with = nullptr;
+		char code[7];
+
+		switch(f)
+		{
+			case filter::html:
+				switch(c)
+				{
+					case '&': with = "&amp;"; break;
+					case '<': with = "&lt;"; break;
+					case '>': with = "&gt;"; break;
+					case '"': with = "&quot;"; break;
+					case '\'': with = "&#39;"; break;
+				}
+				break;
+
+			case filter::url:
+				if(!(unsigned((c | 0x20) - 'a') < 26 || unsigned(c - '0') < 10
+				|| c == '-' || c == '.' || c == '_' || c == '~'))
+				{
+					code[0] = '%';
+					code[1] = hex[c >> 4];
+					code[2] = hex[c & 15];
+					code[3] = '\0';
+					with = code;
+				}
+				break;
+
+			case filter::json:
+				switch(c)
+				{
+					case '"': with = "\\\""; break;
+					case '\\': with = "\\\\"; break;
+					case '\n': with = "\\n"; break;
+					case '\r': with = "\\r"; break;
+					case '\t': with = "\\t"; break;
+					case '\b': with = "\\b"; break;
+					case '\f': with = "\\f"; break;
+					default:
+						if(c < 0x20)
+						{
+							std::memcpy(code, "\\u00", 4);
+							code[4] = hex[c >> 4];
+							code[5] = hex[c & 15];
+							code[6] = '\0';
+							with = code;
+						}
+				}
+				break;
+
+			case filter::none:
+				break;
+		}
+
+		if(with)
+		{
+			out.append(run, p);
+			out.append(with);
+			run = p + 1;
+		}
+	}
+
+	out.append(run, end);
+}
+
+} // namespace string_utils
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_TEXT_TEMPLATE_H
@@ -22,6 +22,8 @@
 // SOFTWARE.
 //
 
+#include <algorithm>
+#include <functional>
 #include <future>
 #include <mutex>
 #include <queue>
@@ -632,13 +634,15 @@ public:
 private:
 	void actual_start(unsigned size)
 	{
+		// must be cleared before the threads start or they exit immediately
+		done = false;
+
 		{
 			std::unique_lock<std::mutex> lock(mtx);
 			while(size--)
 				threads.emplace_back(&thread_pool::process, this);
 		}
 
-		done = false;
 		cv.notify_all();
 	}
 
@@ -22,13 +22,64 @@
 // SOFTWARE.
 //
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 #include <condition_variable>
 
+#include "misc_utils.h"
+
+#if defined(__unix__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  ifndef HOL_HAS_RDTSC
+#    define HOL_HAS_RDTSC
+#  endif
+#  include <fstream>
+#  include <sstream>
+#  include <x86intrin.h>
+#endif
+
+#ifndef HOL_TRACE_BUFFER_SIZE
+#define HOL_TRACE_BUFFER_SIZE 16384 // spans per thread (must be a power of 2)
+#endif
+
+#define HOL_TRACE_CONCAT_IMPL(a, b) a##b
+#define HOL_TRACE_CONCAT(a, b) HOL_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Usage:
+ *
+ * void process()
+ * {
+ *     HOL_TRACE_SCOPE("process"); // records from here to the end of scope
+ *     // ...
+ * }
+ *
+ * std::ofstream ofs("trace.json");
+ * hol::write_chrome_trace(ofs); // open in chrome://tracing or ui.perfetto.dev
+ *
+ * Define HOL_TRACE_DISABLE to compile all the trace scopes away.
+ */
+#ifdef HOL_TRACE_DISABLE
+#define HOL_TRACE_SCOPE(name) do{}while(0)
+#define HOL_TRACE_FUNCTION() do{}while(0)
+#else
+#define HOL_TRACE_SCOPE(name) \
+	::header_only_library::timers::trace_scope HOL_TRACE_CONCAT(hol_trace_scope_, __LINE__)(name)
+#define HOL_TRACE_FUNCTION() HOL_TRACE_SCOPE(__func__)
+#endif
+
 namespace header_only_library {
 namespace timers {
 
@@ -128,6 +179,161 @@ using LinuxMonotonicTimer = Timer<LinuxTimerImpl<CLOCK_MONOTONIC_RAW>>;
 using LinuxThreadTimer = Timer<LinuxTimerImpl<CLOCK_THREAD_CPUTIME_ID>>;
 using LinuxProcessTimer = Timer<LinuxTimerImpl<CLOCK_PROCESS_CPUTIME_ID>>;
 
+#ifdef HOL_HAS_RDTSC
+
+namespace detail {
+
+inline std::int64_t monotonic_raw_nsecs() noexcept
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (std::int64_t(ts.tv_sec) * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * The TSC is only usable as a clock if it ticks at a constant
+ * rate (constant_tsc) and keeps ticking in deep C-states (nonstop_tsc).
+ */
+inline bool tsc_is_invariant()
+{
+	std::ifstream ifs("/proc/cpuinfo");
+
+	std::string line;
+	while(std::getline(ifs, line))
+	{
+		if(line.compare(0, 5, "flags"))
+			continue;
+
+		bool constant_tsc = false;
+		bool nonstop_tsc = false;
+
+		std::istringstream iss(line);
+		for(std::string flag; iss >> flag;)
+		{
+			if(flag == "constant_tsc")
+				constant_tsc = true;
+			else if(flag == "nonstop_tsc")
+				nonstop_tsc = true;
+		}
+
+		return constant_tsc && nonstop_tsc;
+	}
+
+	return false;
+}
+
+struct tsc_calibration
+{
+	bool reliable = false;
+	double nsecs_per_tick = 1.0;
+};
+
+/**
+ * Measure the TSC frequency against CLOCK_MONOTONIC_RAW by spinning
+ * for `ms` milliseconds.
+ */
+inline tsc_calibration calibrate_tsc(std::int64_t ms = 10)
+{
+	tsc_calibration cal;
+
+	if(!tsc_is_invariant())
+		return cal;
+
+	// bracket the clock reads with TSC reads and take the midpoint
+	auto tb0 = __rdtsc();
+	auto nb = monotonic_raw_nsecs();
+	auto tb1 = __rdtsc();
+
+	auto ne = nb;
+	while((ne = monotonic_raw_nsecs()) - nb < ms * 1000000)
+		_mm_pause();
+
+	auto te0 = __rdtsc();
+	ne = monotonic_raw_nsecs();
+	auto te1 = __rdtsc();
+
+	auto ticks = double((te0 + te1) / 2 - (tb0 + tb1) / 2);
+
+	if(ticks > 0)
+	{
+		cal.reliable = true;
+		cal.nsecs_per_tick = double(ne - nb) / ticks;
+	}
+
+	return cal;
+}
+
+inline tsc_calibration const& tsc()
+{
+	static tsc_calibration const cal = calibrate_tsc();
+	return cal;
+}
+
+} // namespace detail
+
+/**
+ * Timer implementation that reads the CPU's time stamp counter
+ * which is much cheaper than calling clock_gettime().
+ *
+ * The TSC is calibrated against CLOCK_MONOTONIC_RAW on first use (call
+ * calibrate() at startup to avoid paying for that inside a measurement).
+ * If /proc/cpuinfo does not report an invariant TSC this falls back to
+ * reading CLOCK_MONOTONIC_RAW.
+ */
+class RdtscTimerImpl
+{
+	std::uint64_t tsb;
+	std::uint64_t tse;
+
+public:
+	RdtscTimerImpl() { calibrate(); }
+
+	void clear() { start(); tse = tsb; }
+
+	void start()
+	{
+		if(HOL_UNLIKELY(!reliable()))
+		{
+			tsb = std::uint64_t(detail::monotonic_raw_nsecs());
+			return;
+		}
+
+		// don't let earlier instructions leak into the measurement
+		_mm_lfence();
+		tsb = __rdtsc();
+		_mm_lfence();
+	}
+
+	void stop()
+	{
+		if(HOL_UNLIKELY(!reliable()))
+		{
+			tse = std::uint64_t(detail::monotonic_raw_nsecs());
+			return;
+		}
+
+		// rdtscp waits for the measured instructions to complete
+		unsigned aux;
+		tse = __rdtscp(&aux);
+		_mm_lfence();
+	}
+
+	std::int64_t nsecs() const
+	{
+		return std::int64_t(double(std::int64_t(tse - tsb)) * detail::tsc().nsecs_per_tick);
+	}
+
+	std::int64_t ticks() const { return std::int64_t(tse - tsb); }
+
+	static void calibrate() { detail::tsc(); }
+	static bool reliable() { return detail::tsc().reliable; }
+	static double nsecs_per_tick() { return detail::tsc().nsecs_per_tick; }
+};
+
+using RdtscTimer = Timer<RdtscTimerImpl>;
+
+#endif // HOL_HAS_RDTSC
+
 #endif
 
 class sleep_timer
@@ -303,6 +509,754 @@ private:
 	std::condition_variable cv;
 };
 
+//=============================================================
+//== Timing wheel
+//=============================================================
+//
+// Usage:
+//
+//	hol::timer_wheel wheel{std::chrono::milliseconds(100)};
+//	wheel.start();
+//
+//	auto id = wheel.schedule(std::chrono::seconds(30), [conn]{ conn->close(); });
+//	wheel.reschedule(id, std::chrono::seconds(30)); // on activity
+//	wheel.cancel(id); // on close
+//
+// Every timeout is rounded up to a whole number of ticks and the wheel's
+// thread only wakes once per tick (and not at all when no timers are
+// scheduled). So a coarse tick, like 100ms, suits large numbers of
+// per-connection timeouts.
+//
+
+/**
+ * Handle to a scheduled timer, only valid until the timer
+ * fires or is cancelled.
+ */
+class timer_id
+{
+public:
+	timer_id() = default;
+
+	explicit operator bool() const { return id != 0; }
+
+	bool operator==(timer_id other) const { return id == other.id; }
+	bool operator!=(timer_id other) const { return id != other.id; }
+
+private:
+	friend class timer_wheel;
+
+	timer_id(std::uint32_t index, std::uint32_t generation)
+	: id((std::uint64_t(generation) << 32) | index) {}
+
+	std::uint32_t index() const { return std::uint32_t(id); }
+	std::uint32_t generation() const { return std::uint32_t(id >> 32); }
+
+	std::uint64_t id = 0;
+};
+
+/**
+ * Hierarchical timing wheel (4 levels of 256 slots) providing O(1)
+ * schedule, reschedule and cancel for very large numbers of timers.
+ *
+ * By default callbacks are run on the wheel's own thread so they should
+ * be short (and must not throw). Use dispatch_to() to hand them to a
+ * thread_pool instead.
+ */
+class timer_wheel
+{
+public:
+	using clock = std::chrono::steady_clock;
+	using callback = std::function<void()>;
+	using dispatcher = std::function<void(callback)>;
+
+	static constexpr unsigned level_bits = 8;
+	static constexpr unsigned levels = 4;
+	static constexpr std::uint32_t slots = 1U << level_bits;
+
+	explicit timer_wheel(clock::duration tick = std::chrono::milliseconds(1))
+	: tick_length(tick)
+	{
+		if(tick <= clock::duration::zero())
+			throw std::invalid_argument("timer_wheel tick must be greater than zero");
+
+		for(auto& level: wheel)
+			level.fill(std::uint32_t(nil));
+
+		nodes.emplace_back(); // index 0 is never used so timer_id{} is invalid
+	}
+
+	timer_wheel(timer_wheel const&) = delete;
+	timer_wheel& operator=(timer_wheel const&) = delete;
+
+	~timer_wheel() { stop(); }
+
+	/**
+	 * Run callbacks by passing them to `pool.add()` rather
+	 * than calling them on the wheel thread. Call before start().
+	 */
+	template<typename Pool>
+	void dispatch_to(Pool& pool)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		dispatch = [&pool](callback func){ pool.add(std::move(func)); };
+	}
+
+	void start()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if(thread.joinable())
+			throw std::runtime_error("timer_wheel is already running");
+
+		done = false;
+		epoch = clock::now() - (tick_length * std::int64_t(now_tick));
+		thread = std::thread(&timer_wheel::wheel_thread, this);
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			done = true;
+		}
+
+		cv.notify_all();
+
+		if(thread.joinable() && thread.get_id() != std::this_thread::get_id())
+			thread.join();
+	}
+
+	/**
+	 * Call `func` once, after `timeout` has elapsed.
+	 */
+	template<typename Func>
+	timer_id schedule(clock::duration timeout, Func&& func)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+
+		bool was_empty = !active;
+
+		if(was_empty && thread.joinable())
+			now_tick = current_tick(); // nothing to cascade so just catch up
+
+		auto index = allocate();
+		nodes[index].func = std::forward<Func>(func);
+		insert(index, now_tick + ticks_for(timeout));
+		++active;
+
+		// read under the lock: once unlocked the timer may fire and
+		// release its slot, and nodes may be reallocated
+		timer_id const id(index, nodes[index].generation);
+
+		lock.unlock();
+
+		if(was_empty)
+			cv.notify_all();
+
+		return id;
+	}
+
+	/**
+	 * Restart the countdown of a pending timer from now.
+	 * @return false if the timer has already fired or been cancelled.
+	 */
+	bool reschedule(timer_id id, clock::duration timeout)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if(!valid(id))
+			return false;
+
+		unlink(id.index());
+		insert(id.index(), now_tick + ticks_for(timeout));
+
+		return true;
+	}
+
+	/**
+	 * @return false if the timer has already fired or been cancelled.
+	 */
+	bool cancel(timer_id id)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if(!valid(id))
+			return false;
+
+		unlink(id.index());
+		release(id.index());
+		--active;
+
+		return true;
+	}
+
+	std::size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return active;
+	}
+
+	clock::duration tick() const { return tick_length; }
+
+	/**
+	 * Advance the wheel by `n` ticks, running the callbacks that expire.
+	 * For driving the wheel from an existing event loop instead
+	 * of calling start().
+	 */
+	void advance(std::size_t n = 1)
+	{
+		std::vector<callback> expired;
+
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			while(n--)
+				advance_one(expired);
+		}
+
+		run(expired);
+	}
+
+private:
+	static constexpr std::uint32_t nil = 0;
+
+	struct node
+	{
+		callback func;
+		std::uint64_t expiry = 0;
+		std::uint32_t prev = nil;
+		std::uint32_t next = nil;
+		std::uint32_t generation = 1;
+		std::uint16_t slot = 0; // level * slots + slot
+		bool live = false;
+	};
+
+	std::uint64_t ticks_for(clock::duration timeout) const
+	{
+		if(timeout <= clock::duration::zero())
+			return 1;
+
+		return std::uint64_t((timeout + tick_length - clock::duration(1)) / tick_length);
+	}
+
+	std::uint64_t current_tick() const
+	{
+		return std::uint64_t((clock::now() - epoch) / tick_length);
+	}
+
+	bool valid(timer_id id) const
+	{
+		return id.index() && id.index() < nodes.size()
+			&& nodes[id.index()].live
+			&& nodes[id.index()].generation == id.generation();
+	}
+
+	std::uint32_t allocate()
+	{
+		if(free_list != nil)
+		{
+			auto index = free_list;
+			free_list = nodes[index].next;
+			nodes[index].live = true;
+			return index;
+		}
+
+		if(nodes.size() == std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("too many timers");
+
+		nodes.emplace_back();
+		nodes.back().live = true;
+		return std::uint32_t(nodes.size() - 1);
+	}
+
+	void release(std::uint32_t index)
+	{
+		auto& n = nodes[index];
+		n.func = nullptr;
+		n.live = false;
+		++n.generation;
+		if(!n.generation)
+			n.generation = 1;
+		n.next = free_list;
+		free_list = index;
+	}
+
+	void insert(std::uint32_t index, std::uint64_t expiry)
+	{
+		auto& n = nodes[index];
+		n.expiry = expiry;
+
+		auto delta = expiry > now_tick ? expiry - now_tick : 0;
+
+		unsigned level = 0;
+		while(level < levels - 1 && delta >= (std::uint64_t(1) << ((level + 1) * level_bits)))
+			++level;
+
+		auto slot = std::uint32_t(expiry >> (level * level_bits)) & (slots - 1);
+
+		auto& head = wheel[level][slot];
+		n.slot = std::uint16_t(level * slots + slot);
+		n.prev = nil;
+		n.next = head;
+		if(head != nil)
+			nodes[head].prev = index;
+		head = index;
+	}
+
+	void unlink(std::uint32_t index)
+	{
+		auto& n = nodes[index];
+
+		if(n.prev != nil)
+			nodes[n.prev].next = n.next;
+		else
+			wheel[n.slot / slots][n.slot % slots] = n.next;
+
+		if(n.next != nil)
+			nodes[n.next].prev = n.prev;
+	}
+
+	//! Move all the timers in a higher level slot down to where they now belong.
+	void cascade(unsigned level)
+	{
+		auto slot = std::uint32_t(now_tick >> (level * level_bits)) & (slots - 1);
+
+		auto index = wheel[level][slot];
+		wheel[level][slot] = nil;
+
+		while(index != nil)
+		{
+			auto next = nodes[index].next;
+			insert(index, nodes[index].expiry);
+			index = next;
+		}
+	}
+
+	void advance_one(std::vector<callback>& expired)
+	{
+		++now_tick;
+
+		for(unsigned level = 1; level < levels; ++level)
+		{
+			if(now_tick & ((std::uint64_t(1) << (level * level_bits)) - 1))
+				break;
+			cascade(level);
+		}
+
+		auto& head = wheel[0][now_tick & (slots - 1)];
+		auto index = head;
+		head = nil;
+
+		while(index != nil)
+		{
+			auto next = nodes[index].next;
+			expired.push_back(std::move(nodes[index].func));
+			release(index);
+			--active;
+			index = next;
+		}
+	}
+
+	void run(std::vector<callback>& expired)
+	{
+		for(auto& func: expired)
+		{
+			if(dispatch)
+				dispatch(std::move(func));
+			else
+				func();
+		}
+
+		expired.clear();
+	}
+
+	void wheel_thread()
+	{
+		std::vector<callback> expired;
+		std::unique_lock<std::mutex> lock(mtx);
+
+		while(!done)
+		{
+			if(!active)
+			{
+				cv.wait(lock, [this]{ return done || active; });
+				continue;
+			}
+
+			cv.wait_until(lock, epoch + tick_length * std::int64_t(now_tick + 1),
+				[this]{ return done; });
+
+			if(done)
+				break;
+
+			// catch up if we were held up for more than a tick
+			for(auto target = current_tick(); now_tick < target;)
+				advance_one(expired);
+
+			if(expired.empty())
+				continue;
+
+			lock.unlock();
+			run(expired);
+			lock.lock();
+		}
+	}
+
+	clock::duration const tick_length;
+	clock::time_point epoch = clock::now();
+	std::uint64_t now_tick = 0;
+
+	std::array<std::array<std::uint32_t, slots>, levels> wheel;
+	std::vector<node> nodes;
+	std::uint32_t free_list = nil;
+	std::size_t active = 0;
+
+	dispatcher dispatch;
+
+	bool done = false;
+	mutable std::mutex mtx;
+	std::condition_variable cv;
+	std::thread thread;
+};
+
+//=============================================================
+//== Scoped tracing
+//=============================================================
+//
+// Every thread records its spans into its own fixed size ring buffer
+// so recording a span never takes a lock. When a buffer fills up the
+// oldest spans are overwritten.
+//
+// When a thread exits its buffer keeps its spans, for export, until
+// a new thread starts tracing. The new thread then takes the buffer
+// over (under a new thread id) and the old spans are discarded. So
+// the memory used is bounded by the largest number of threads ever
+// tracing at once, however many threads come and go.
+//
+
+namespace detail { class trace_registry; }
+
+struct trace_record
+{
+	char const* name;
+	std::uint64_t beg; // nanoseconds
+	std::uint64_t end; // nanoseconds
+};
+
+class trace_buffer
+{
+public:
+	static constexpr std::size_t capacity = HOL_TRACE_BUFFER_SIZE;
+
+	static_assert(capacity && !(capacity & (capacity - 1)),
+		"HOL_TRACE_BUFFER_SIZE must be a power of 2");
+
+	explicit trace_buffer(unsigned tid): tid(tid) {}
+
+	trace_buffer(trace_buffer const&) = delete;
+	trace_buffer& operator=(trace_buffer const&) = delete;
+
+	//! Only to be called by the owning thread.
+	void record(char const* name, std::uint64_t beg, std::uint64_t end) noexcept
+	{
+		auto const n = head.load(std::memory_order_relaxed);
+		auto& r = records[n & (capacity - 1)];
+
+		// seqlock: mark the slot busy before overwriting it
+		r.seq.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		r.name.store(name, std::memory_order_relaxed);
+		r.beg.store(beg, std::memory_order_relaxed);
+		r.end.store(end, std::memory_order_relaxed);
+
+		r.seq.store(n + 1, std::memory_order_release);
+		head.store(n + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Copy out the recorded spans, oldest first. This may be called
+	 * while the owning thread is still recording, any spans that
+	 * were overwritten (or were being written) during the copy
+	 * are dropped.
+	 */
+	std::vector<trace_record> snapshot() const
+	{
+		auto const n = head.load(std::memory_order_acquire);
+		auto const b = std::max(start.load(std::memory_order_acquire),
+			n > capacity ? n - capacity : 0);
+
+		std::vector<trace_record> v;
+		v.reserve(n - std::min(n, b));
+
+		for(auto i = b; i < n; ++i)
+		{
+			auto const& r = records[i & (capacity - 1)];
+
+			auto const seq = r.seq.load(std::memory_order_acquire);
+			trace_record const copy{r.name.load(std::memory_order_relaxed),
+				r.beg.load(std::memory_order_relaxed), r.end.load(std::memory_order_relaxed)};
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// still holds span i from before the copy to after it
+			if(seq == i + 1 && r.seq.load(std::memory_order_relaxed) == seq)
+				v.push_back(copy);
+		}
+
+		return v;
+	}
+
+	//! Discard the spans recorded so far.
+	void clear() noexcept { start.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+	unsigned thread_id() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return tid;
+	}
+
+	std::string thread_name() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return name;
+	}
+
+	void thread_name(std::string const& name)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		this->name = name;
+	}
+
+private:
+	friend class detail::trace_registry;
+
+	// a trace_record whose fields can be read while being written
+	struct slot
+	{
+		std::atomic<std::size_t> seq{0}; // span index + 1, 0 while writing
+		std::atomic<char const*> name{nullptr};
+		std::atomic<std::uint64_t> beg{0};
+		std::atomic<std::uint64_t> end{0};
+	};
+
+	//! Hand the buffer to a new thread.
+	void reuse(unsigned tid)
+	{
+		clear();
+		std::lock_guard<std::mutex> lock(mtx);
+		this->tid = tid;
+		name.clear();
+	}
+
+	std::atomic<std::size_t> head{0};
+	std::atomic<std::size_t> start{0}; // spans before this are cleared
+	std::array<slot, capacity> records;
+
+	mutable std::mutex mtx;
+	unsigned tid;
+	std::string name;
+};
+
+namespace detail {
+
+class trace_registry
+{
+public:
+	using buffer_sptr = std::shared_ptr<trace_buffer>;
+
+	static trace_registry& instance()
+	{
+		static trace_registry registry;
+		return registry;
+	}
+
+	//! A buffer for a new thread, reusing one released by an exited thread.
+	buffer_sptr acquire()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if(!released.empty())
+		{
+			auto buffer = released.back();
+			released.pop_back();
+			buffer->reuse(++tids);
+			return buffer;
+		}
+
+		buffers.push_back(std::make_shared<trace_buffer>(++tids));
+		return buffers.back();
+	}
+
+	//! Keep the spans of an exited thread until its buffer is needed.
+	void release(buffer_sptr buffer)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		released.push_back(std::move(buffer));
+	}
+
+	std::vector<buffer_sptr> all() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return buffers;
+	}
+
+private:
+	mutable std::mutex mtx;
+	std::vector<buffer_sptr> buffers;  // every buffer, for export
+	std::vector<buffer_sptr> released; // buffers of exited threads
+	unsigned tids = 0;
+};
+
+//! Returns the thread's buffer to the registry when the thread exits.
+struct trace_buffer_owner
+{
+	trace_registry::buffer_sptr buffer = trace_registry::instance().acquire();
+	~trace_buffer_owner() { trace_registry::instance().release(std::move(buffer)); }
+};
+
+inline trace_buffer& local_trace_buffer()
+{
+	thread_local static trace_buffer_owner owner;
+	return *owner.buffer;
+}
+
+inline std::uint64_t trace_clock() noexcept
+{
+	using namespace std::chrono;
+	return std::uint64_t(duration_cast<nanoseconds>(
+		steady_clock::now().time_since_epoch()).count());
+}
+
+inline void write_json_string(std::ostream& os, char const* s)
+{
+	os << '"';
+
+	for(; s && *s; ++s)
+	{
+		switch(*s)
+		{
+			case '"': os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if((unsigned char)(*s) < 0x20)
+					os << "\\u00" << "0123456789abcdef"[(*s >> 4) & 0xF]
+						<< "0123456789abcdef"[*s & 0xF];
+				else
+					os << *s;
+		}
+	}
+
+	os << '"';
+}
+
+// Chrome trace times are microseconds, keep nanosecond precision
+inline void write_usecs(std::ostream& os, std::uint64_t ns)
+{
+	auto fill = os.fill('0');
+	os << (ns / 1000) << '.' << std::setw(3) << (ns % 1000);
+	os.fill(fill);
+}
+
+} // namespace detail
+
+/**
+ * RAII span, records the time between its construction and destruction
+ * into the calling thread's trace buffer. Normally created using
+ * the HOL_TRACE_SCOPE(name) macro.
+ *
+ * @param name Must outlive the export of the trace (use string literals).
+ */
+class trace_scope
+{
+public:
+	explicit trace_scope(char const* name)
+	: buffer(detail::local_trace_buffer()), name(name), beg(detail::trace_clock()) {}
+
+	~trace_scope() { buffer.record(name, beg, detail::trace_clock()); }
+
+	trace_scope(trace_scope const&) = delete;
+	trace_scope& operator=(trace_scope const&) = delete;
+
+private:
+	trace_buffer& buffer;
+	char const* name;
+	std::uint64_t beg;
+};
+
+/**
+ * Give the calling thread a name to display in the trace viewer.
+ */
+inline void trace_thread_name(std::string const& name)
+{
+	detail::local_trace_buffer().thread_name(name);
+}
+
+/**
+ * Discard all the recorded spans. Spans recorded by other
+ * threads during the call may or may not be kept.
+ */
+inline void clear_trace()
+{
+	for(auto const& buffer: detail::trace_registry::instance().all())
+		buffer->clear();
+}
+
+/**
+ * Write every thread's recorded spans in the Chrome Trace Event
+ * JSON format (as read by chrome://tracing and Perfetto).
+ */
+inline void write_chrome_trace(std::ostream& os)
+{
+	struct thread_trace
+	{
+		unsigned tid;
+		std::string name;
+		std::vector<trace_record> records;
+	};
+
+	std::vector<thread_trace> traces;
+	auto base = std::numeric_limits<std::uint64_t>::max();
+
+	for(auto const& buffer: detail::trace_registry::instance().all())
+	{
+		traces.push_back({buffer->thread_id(), buffer->thread_name(), buffer->snapshot()});
+
+		for(auto const& r: traces.back().records)
+			base = std::min(base, r.beg);
+	}
+
+	char const* sep = "\n";
+
+	os << "{\"traceEvents\":[";
+
+	for(auto const& trace: traces)
+	{
+		if(!trace.name.empty())
+		{
+			os << sep << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace.tid;
+			os << ",\"args\":{\"name\":";
+			detail::write_json_string(os, trace.name.c_str());
+			os << "}}";
+			sep = ",\n";
+		}
+
+		for(auto const& r: trace.records)
+		{
+			os << sep << "{\"name\":";
+			detail::write_json_string(os, r.name);
+			os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace.tid << ",\"ts\":";
+			detail::write_usecs(os, r.beg - base);
+			os << ",\"dur\":";
+			detail::write_usecs(os, r.end - r.beg);
+			os << '}';
+			sep = ",\n";
+		}
+	}
+
+	os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
 } // timers
 } // header_only_library
 
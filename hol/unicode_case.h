@@ -0,0 +1,308 @@
+#ifndef HEADER_ONLY_LIBRARY_UNICODE_CASE_H
+#define HEADER_ONLY_LIBRARY_UNICODE_CASE_H
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace header_only_library {
+namespace unicode_utils {
+namespace detail {
+
+// Unicode 14.0 simple (one to one) case mappings from UnicodeData.txt
+// and the C+S entries of CaseFolding.txt, run length encoded:
+// `count` code points from `first`, `stride` apart, each map to
+// themselves plus `delta`.
+
+struct case_range
+{
+	char32_t first;
+	std::uint16_t count;
+	std::uint8_t stride;
+	std::int32_t delta;
+};
+
+template<std::size_t N>
+char32_t map_case(case_range const(&table)[N], char32_t cp)
+{
+	auto r = std::upper_bound(std::begin(table), std::end(table), cp,
+		[](char32_t cp, case_range const& r){ return cp < r.first; });
+
+	if(r == std::begin(table))
+		return cp;
+
+	--r;
+
+	auto const offset = cp - r->first;
+
+	if(offset / r->stride >= r->count || offset % r->stride)
+		return cp;
+
+	return char32_t(std::int32_t(cp) + r->delta);
+}
+
+inline case_range const(&lower_table())[182]
+{
+	static case_range const table[] =
+	{
+		{0x0041, 26, 1, 32}, {0x00C0, 23, 1, 32}, {0x00D8, 7, 1, 32}, {0x0100, 24, 2, 1},
+		{0x0130, 1, 1, -199}, {0x0132, 3, 2, 1}, {0x0139, 8, 2, 1}, {0x014A, 23, 2, 1},
+		{0x0178, 1, 1, -121}, {0x0179, 3, 2, 1}, {0x0181, 1, 1, 210}, {0x0182, 2, 2, 1},
+		{0x0186, 1, 1, 206}, {0x0187, 1, 1, 1}, {0x0189, 2, 1, 205}, {0x018B, 1, 1, 1},
+		{0x018E, 1, 1, 79}, {0x018F, 1, 1, 202}, {0x0190, 1, 1, 203}, {0x0191, 1, 1, 1},
+		{0x0193, 1, 1, 205}, {0x0194, 1, 1, 207}, {0x0196, 1, 1, 211}, {0x0197, 1, 1, 209},
+		{0x0198, 1, 1, 1}, {0x019C, 1, 1, 211}, {0x019D, 1, 1, 213}, {0x019F, 1, 1, 214},
+		{0x01A0, 3, 2, 1}, {0x01A6, 1, 1, 218}, {0x01A7, 1, 1, 1}, {0x01A9, 1, 1, 218},
+		{0x01AC, 1, 1, 1}, {0x01AE, 1, 1, 218}, {0x01AF, 1, 1, 1}, {0x01B1, 2, 1, 217},
+		{0x01B3, 2, 2, 1}, {0x01B7, 1, 1, 219}, {0x01B8, 1, 1, 1}, {0x01BC, 1, 1, 1},
+		{0x01C4, 1, 1, 2}, {0x01C5, 1, 1, 1}, {0x01C7, 1, 1, 2}, {0x01C8, 1, 1, 1},
+		{0x01CA, 1, 1, 2}, {0x01CB, 9, 2, 1}, {0x01DE, 9, 2, 1}, {0x01F1, 1, 1, 2},
+		{0x01F2, 2, 2, 1}, {0x01F6, 1, 1, -97}, {0x01F7, 1, 1, -56}, {0x01F8, 20, 2, 1},
+		{0x0220, 1, 1, -130}, {0x0222, 9, 2, 1}, {0x023A, 1, 1, 10795}, {0x023B, 1, 1, 1},
+		{0x023D, 1, 1, -163}, {0x023E, 1, 1, 10792}, {0x0241, 1, 1, 1}, {0x0243, 1, 1, -195},
+		{0x0244, 1, 1, 69}, {0x0245, 1, 1, 71}, {0x0246, 5, 2, 1}, {0x0370, 2, 2, 1},
+		{0x0376, 1, 1, 1}, {0x037F, 1, 1, 116}, {0x0386, 1, 1, 38}, {0x0388, 3, 1, 37},
+		{0x038C, 1, 1, 64}, {0x038E, 2, 1, 63}, {0x0391, 17, 1, 32}, {0x03A3, 9, 1, 32},
+		{0x03CF, 1, 1, 8}, {0x03D8, 12, 2, 1}, {0x03F4, 1, 1, -60}, {0x03F7, 1, 1, 1},
+		{0x03F9, 1, 1, -7}, {0x03FA, 1, 1, 1}, {0x03FD, 3, 1, -130}, {0x0400, 16, 1, 80},
+		{0x0410, 32, 1, 32}, {0x0460, 17, 2, 1}, {0x048A, 27, 2, 1}, {0x04C0, 1, 1, 15},
+		{0x04C1, 7, 2, 1}, {0x04D0, 48, 2, 1}, {0x0531, 38, 1, 48}, {0x10A0, 38, 1, 7264},
+		{0x10C7, 1, 1, 7264}, {0x10CD, 1, 1, 7264}, {0x13A0, 80, 1, 38864}, {0x13F0, 6, 1, 8},
+		{0x1C90, 43, 1, -3008}, {0x1CBD, 3, 1, -3008}, {0x1E00, 75, 2, 1}, {0x1E9E, 1, 1, -7615},
+		{0x1EA0, 48, 2, 1}, {0x1F08, 8, 1, -8}, {0x1F18, 6, 1, -8}, {0x1F28, 8, 1, -8},
+		{0x1F38, 8, 1, -8}, {0x1F48, 6, 1, -8}, {0x1F59, 4, 2, -8}, {0x1F68, 8, 1, -8},
+		{0x1F88, 8, 1, -8}, {0x1F98, 8, 1, -8}, {0x1FA8, 8, 1, -8}, {0x1FB8, 2, 1, -8},
+		{0x1FBA, 2, 1, -74}, {0x1FBC, 1, 1, -9}, {0x1FC8, 4, 1, -86}, {0x1FCC, 1, 1, -9},
+		{0x1FD8, 2, 1, -8}, {0x1FDA, 2, 1, -100}, {0x1FE8, 2, 1, -8}, {0x1FEA, 2, 1, -112},
+		{0x1FEC, 1, 1, -7}, {0x1FF8, 2, 1, -128}, {0x1FFA, 2, 1, -126}, {0x1FFC, 1, 1, -9},
+		{0x2126, 1, 1, -7517}, {0x212A, 1, 1, -8383}, {0x212B, 1, 1, -8262}, {0x2132, 1, 1, 28},
+		{0x2160, 16, 1, 16}, {0x2183, 1, 1, 1}, {0x24B6, 26, 1, 26}, {0x2C00, 48, 1, 48},
+		{0x2C60, 1, 1, 1}, {0x2C62, 1, 1, -10743}, {0x2C63, 1, 1, -3814}, {0x2C64, 1, 1, -10727},
+		{0x2C67, 3, 2, 1}, {0x2C6D, 1, 1, -10780}, {0x2C6E, 1, 1, -10749}, {0x2C6F, 1, 1, -10783},
+		{0x2C70, 1, 1, -10782}, {0x2C72, 1, 1, 1}, {0x2C75, 1, 1, 1}, {0x2C7E, 2, 1, -10815},
+		{0x2C80, 50, 2, 1}, {0x2CEB, 2, 2, 1}, {0x2CF2, 1, 1, 1}, {0xA640, 23, 2, 1},
+		{0xA680, 14, 2, 1}, {0xA722, 7, 2, 1}, {0xA732, 31, 2, 1}, {0xA779, 2, 2, 1},
+		{0xA77D, 1, 1, -35332}, {0xA77E, 5, 2, 1}, {0xA78B, 1, 1, 1}, {0xA78D, 1, 1, -42280},
+		{0xA790, 2, 2, 1}, {0xA796, 10, 2, 1}, {0xA7AA, 1, 1, -42308}, {0xA7AB, 1, 1, -42319},
+		{0xA7AC, 1, 1, -42315}, {0xA7AD, 1, 1, -42305}, {0xA7AE, 1, 1, -42308}, {0xA7B0, 1, 1, -42258},
+		{0xA7B1, 1, 1, -42282}, {0xA7B2, 1, 1, -42261}, {0xA7B3, 1, 1, 928}, {0xA7B4, 8, 2, 1},
+		{0xA7C4, 1, 1, -48}, {0xA7C5, 1, 1, -42307}, {0xA7C6, 1, 1, -35384}, {0xA7C7, 2, 2, 1},
+		{0xA7D0, 1, 1, 1}, {0xA7D6, 2, 2, 1}, {0xA7F5, 1, 1, 1}, {0xFF21, 26, 1, 32},
+		{0x10400, 40, 1, 40}, {0x104B0, 36, 1, 40}, {0x10570, 11, 1, 39}, {0x1057C, 15, 1, 39},
+		{0x1058C, 7, 1, 39}, {0x10594, 2, 1, 39}, {0x10C80, 51, 1, 64}, {0x118A0, 32, 1, 32},
+		{0x16E40, 32, 1, 32}, {0x1E900, 34, 1, 34},
+	};
+	return table;
+}
+
+inline case_range const(&upper_table())[200]
+{
+	static case_range const table[] =
+	{
+		{0x0061, 26, 1, -32}, {0x00B5, 1, 1, 743}, {0x00E0, 23, 1, -32}, {0x00F8, 7, 1, -32},
+		{0x00FF, 1, 1, 121}, {0x0101, 24, 2, -1}, {0x0131, 1, 1, -232}, {0x0133, 3, 2, -1},
+		{0x013A, 8, 2, -1}, {0x014B, 23, 2, -1}, {0x017A, 3, 2, -1}, {0x017F, 1, 1, -300},
+		{0x0180, 1, 1, 195}, {0x0183, 2, 2, -1}, {0x0188, 1, 1, -1}, {0x018C, 1, 1, -1},
+		{0x0192, 1, 1, -1}, {0x0195, 1, 1, 97}, {0x0199, 1, 1, -1}, {0x019A, 1, 1, 163},
+		{0x019E, 1, 1, 130}, {0x01A1, 3, 2, -1}, {0x01A8, 1, 1, -1}, {0x01AD, 1, 1, -1},
+		{0x01B0, 1, 1, -1}, {0x01B4, 2, 2, -1}, {0x01B9, 1, 1, -1}, {0x01BD, 1, 1, -1},
+		{0x01BF, 1, 1, 56}, {0x01C5, 1, 1, -1}, {0x01C6, 1, 1, -2}, {0x01C8, 1, 1, -1},
+		{0x01C9, 1, 1, -2}, {0x01CB, 1, 1, -1}, {0x01CC, 1, 1, -2}, {0x01CE, 8, 2, -1},
+		{0x01DD, 1, 1, -79}, {0x01DF, 9, 2, -1}, {0x01F2, 1, 1, -1}, {0x01F3, 1, 1, -2},
+		{0x01F5, 1, 1, -1}, {0x01F9, 20, 2, -1}, {0x0223, 9, 2, -1}, {0x023C, 1, 1, -1},
+		{0x023F, 2, 1, 10815}, {0x0242, 1, 1, -1}, {0x0247, 5, 2, -1}, {0x0250, 1, 1, 10783},
+		{0x0251, 1, 1, 10780}, {0x0252, 1, 1, 10782}, {0x0253, 1, 1, -210}, {0x0254, 1, 1, -206},
+		{0x0256, 2, 1, -205}, {0x0259, 1, 1, -202}, {0x025B, 1, 1, -203}, {0x025C, 1, 1, 42319},
+		{0x0260, 1, 1, -205}, {0x0261, 1, 1, 42315}, {0x0263, 1, 1, -207}, {0x0265, 1, 1, 42280},
+		{0x0266, 1, 1, 42308}, {0x0268, 1, 1, -209}, {0x0269, 1, 1, -211}, {0x026A, 1, 1, 42308},
+		{0x026B, 1, 1, 10743}, {0x026C, 1, 1, 42305}, {0x026F, 1, 1, -211}, {0x0271, 1, 1, 10749},
+		{0x0272, 1, 1, -213}, {0x0275, 1, 1, -214}, {0x027D, 1, 1, 10727}, {0x0280, 1, 1, -218},
+		{0x0282, 1, 1, 42307}, {0x0283, 1, 1, -218}, {0x0287, 1, 1, 42282}, {0x0288, 1, 1, -218},
+		{0x0289, 1, 1, -69}, {0x028A, 2, 1, -217}, {0x028C, 1, 1, -71}, {0x0292, 1, 1, -219},
+		{0x029D, 1, 1, 42261}, {0x029E, 1, 1, 42258}, {0x0345, 1, 1, 84}, {0x0371, 2, 2, -1},
+		{0x0377, 1, 1, -1}, {0x037B, 3, 1, 130}, {0x03AC, 1, 1, -38}, {0x03AD, 3, 1, -37},
+		{0x03B1, 17, 1, -32}, {0x03C2, 1, 1, -31}, {0x03C3, 9, 1, -32}, {0x03CC, 1, 1, -64},
+		{0x03CD, 2, 1, -63}, {0x03D0, 1, 1, -62}, {0x03D1, 1, 1, -57}, {0x03D5, 1, 1, -47},
+		{0x03D6, 1, 1, -54}, {0x03D7, 1, 1, -8}, {0x03D9, 12, 2, -1}, {0x03F0, 1, 1, -86},
+		{0x03F1, 1, 1, -80}, {0x03F2, 1, 1, 7}, {0x03F3, 1, 1, -116}, {0x03F5, 1, 1, -96},
+		{0x03F8, 1, 1, -1}, {0x03FB, 1, 1, -1}, {0x0430, 32, 1, -32}, {0x0450, 16, 1, -80},
+		{0x0461, 17, 2, -1}, {0x048B, 27, 2, -1}, {0x04C2, 7, 2, -1}, {0x04CF, 1, 1, -15},
+		{0x04D1, 48, 2, -1}, {0x0561, 38, 1, -48}, {0x10D0, 43, 1, 3008}, {0x10FD, 3, 1, 3008},
+		{0x13F8, 6, 1, -8}, {0x1C80, 1, 1, -6254}, {0x1C81, 1, 1, -6253}, {0x1C82, 1, 1, -6244},
+		{0x1C83, 2, 1, -6242}, {0x1C85, 1, 1, -6243}, {0x1C86, 1, 1, -6236}, {0x1C87, 1, 1, -6181},
+		{0x1C88, 1, 1, 35266}, {0x1D79, 1, 1, 35332}, {0x1D7D, 1, 1, 3814}, {0x1D8E, 1, 1, 35384},
+		{0x1E01, 75, 2, -1}, {0x1E9B, 1, 1, -59}, {0x1EA1, 48, 2, -1}, {0x1F00, 8, 1, 8},
+		{0x1F10, 6, 1, 8}, {0x1F20, 8, 1, 8}, {0x1F30, 8, 1, 8}, {0x1F40, 6, 1, 8},
+		{0x1F51, 4, 2, 8}, {0x1F60, 8, 1, 8}, {0x1F70, 2, 1, 74}, {0x1F72, 4, 1, 86},
+		{0x1F76, 2, 1, 100}, {0x1F78, 2, 1, 128}, {0x1F7A, 2, 1, 112}, {0x1F7C, 2, 1, 126},
+		{0x1F80, 8, 1, 8}, {0x1F90, 8, 1, 8}, {0x1FA0, 8, 1, 8}, {0x1FB0, 2, 1, 8},
+		{0x1FB3, 1, 1, 9}, {0x1FBE, 1, 1, -7205}, {0x1FC3, 1, 1, 9}, {0x1FD0, 2, 1, 8},
+		{0x1FE0, 2, 1, 8}, {0x1FE5, 1, 1, 7}, {0x1FF3, 1, 1, 9}, {0x214E, 1, 1, -28},
+		{0x2170, 16, 1, -16}, {0x2184, 1, 1, -1}, {0x24D0, 26, 1, -26}, {0x2C30, 48, 1, -48},
+		{0x2C61, 1, 1, -1}, {0x2C65, 1, 1, -10795}, {0x2C66, 1, 1, -10792}, {0x2C68, 3, 2, -1},
+		{0x2C73, 1, 1, -1}, {0x2C76, 1, 1, -1}, {0x2C81, 50, 2, -1}, {0x2CEC, 2, 2, -1},
+		{0x2CF3, 1, 1, -1}, {0x2D00, 38, 1, -7264}, {0x2D27, 1, 1, -7264}, {0x2D2D, 1, 1, -7264},
+		{0xA641, 23, 2, -1}, {0xA681, 14, 2, -1}, {0xA723, 7, 2, -1}, {0xA733, 31, 2, -1},
+		{0xA77A, 2, 2, -1}, {0xA77F, 5, 2, -1}, {0xA78C, 1, 1, -1}, {0xA791, 2, 2, -1},
+		{0xA794, 1, 1, 48}, {0xA797, 10, 2, -1}, {0xA7B5, 8, 2, -1}, {0xA7C8, 2, 2, -1},
+		{0xA7D1, 1, 1, -1}, {0xA7D7, 2, 2, -1}, {0xA7F6, 1, 1, -1}, {0xAB53, 1, 1, -928},
+		{0xAB70, 80, 1, -38864}, {0xFF41, 26, 1, -32}, {0x10428, 40, 1, -40}, {0x104D8, 36, 1, -40},
+		{0x10597, 11, 1, -39}, {0x105A3, 15, 1, -39}, {0x105B3, 7, 1, -39}, {0x105BB, 2, 1, -39},
+		{0x10CC0, 51, 1, -64}, {0x118C0, 32, 1, -32}, {0x16E60, 32, 1, -32}, {0x1E922, 34, 1, -34},
+	};
+	return table;
+}
+
+inline case_range const(&fold_table())[202]
+{
+	static case_range const table[] =
+	{
+		{0x0041, 26, 1, 32}, {0x00B5, 1, 1, 775}, {0x00C0, 23, 1, 32}, {0x00D8, 7, 1, 32},
+		{0x0100, 24, 2, 1}, {0x0132, 3, 2, 1}, {0x0139, 8, 2, 1}, {0x014A, 23, 2, 1},
+		{0x0178, 1, 1, -121}, {0x0179, 3, 2, 1}, {0x017F, 1, 1, -268}, {0x0181, 1, 1, 210},
+		{0x0182, 2, 2, 1}, {0x0186, 1, 1, 206}, {0x0187, 1, 1, 1}, {0x0189, 2, 1, 205},
+		{0x018B, 1, 1, 1}, {0x018E, 1, 1, 79}, {0x018F, 1, 1, 202}, {0x0190, 1, 1, 203},
+		{0x0191, 1, 1, 1}, {0x0193, 1, 1, 205}, {0x0194, 1, 1, 207}, {0x0196, 1, 1, 211},
+		{0x0197, 1, 1, 209}, {0x0198, 1, 1, 1}, {0x019C, 1, 1, 211}, {0x019D, 1, 1, 213},
+		{0x019F, 1, 1, 214}, {0x01A0, 3, 2, 1}, {0x01A6, 1, 1, 218}, {0x01A7, 1, 1, 1},
+		{0x01A9, 1, 1, 218}, {0x01AC, 1, 1, 1}, {0x01AE, 1, 1, 218}, {0x01AF, 1, 1, 1},
+		{0x01B1, 2, 1, 217}, {0x01B3, 2, 2, 1}, {0x01B7, 1, 1, 219}, {0x01B8, 1, 1, 1},
+		{0x01BC, 1, 1, 1}, {0x01C4, 1, 1, 2}, {0x01C5, 1, 1, 1}, {0x01C7, 1, 1, 2},
+		{0x01C8, 1, 1, 1}, {0x01CA, 1, 1, 2}, {0x01CB, 9, 2, 1}, {0x01DE, 9, 2, 1},
+		{0x01F1, 1, 1, 2}, {0x01F2, 2, 2, 1}, {0x01F6, 1, 1, -97}, {0x01F7, 1, 1, -56},
+		{0x01F8, 20, 2, 1}, {0x0220, 1, 1, -130}, {0x0222, 9, 2, 1}, {0x023A, 1, 1, 10795},
+		{0x023B, 1, 1, 1}, {0x023D, 1, 1, -163}, {0x023E, 1, 1, 10792}, {0x0241, 1, 1, 1},
+		{0x0243, 1, 1, -195}, {0x0244, 1, 1, 69}, {0x0245, 1, 1, 71}, {0x0246, 5, 2, 1},
+		{0x0345, 1, 1, 116}, {0x0370, 2, 2, 1}, {0x0376, 1, 1, 1}, {0x037F, 1, 1, 116},
+		{0x0386, 1, 1, 38}, {0x0388, 3, 1, 37}, {0x038C, 1, 1, 64}, {0x038E, 2, 1, 63},
+		{0x0391, 17, 1, 32}, {0x03A3, 9, 1, 32}, {0x03C2, 1, 1, 1}, {0x03CF, 1, 1, 8},
+		{0x03D0, 1, 1, -30}, {0x03D1, 1, 1, -25}, {0x03D5, 1, 1, -15}, {0x03D6, 1, 1, -22},
+		{0x03D8, 12, 2, 1}, {0x03F0, 1, 1, -54}, {0x03F1, 1, 1, -48}, {0x03F4, 1, 1, -60},
+		{0x03F5, 1, 1, -64}, {0x03F7, 1, 1, 1}, {0x03F9, 1, 1, -7}, {0x03FA, 1, 1, 1},
+		{0x03FD, 3, 1, -130}, {0x0400, 16, 1, 80}, {0x0410, 32, 1, 32}, {0x0460, 17, 2, 1},
+		{0x048A, 27, 2, 1}, {0x04C0, 1, 1, 15}, {0x04C1, 7, 2, 1}, {0x04D0, 48, 2, 1},
+		{0x0531, 38, 1, 48}, {0x10A0, 38, 1, 7264}, {0x10C7, 1, 1, 7264}, {0x10CD, 1, 1, 7264},
+		{0x13F8, 6, 1, -8}, {0x1C80, 1, 1, -6222}, {0x1C81, 1, 1, -6221}, {0x1C82, 1, 1, -6212},
+		{0x1C83, 2, 1, -6210}, {0x1C85, 1, 1, -6211}, {0x1C86, 1, 1, -6204}, {0x1C87, 1, 1, -6180},
+		{0x1C88, 1, 1, 35267}, {0x1C90, 43, 1, -3008}, {0x1CBD, 3, 1, -3008}, {0x1E00, 75, 2, 1},
+		{0x1E9B, 1, 1, -58}, {0x1E9E, 1, 1, -7615}, {0x1EA0, 48, 2, 1}, {0x1F08, 8, 1, -8},
+		{0x1F18, 6, 1, -8}, {0x1F28, 8, 1, -8}, {0x1F38, 8, 1, -8}, {0x1F48, 6, 1, -8},
+		{0x1F59, 4, 2, -8}, {0x1F68, 8, 1, -8}, {0x1F88, 8, 1, -8}, {0x1F98, 8, 1, -8},
+		{0x1FA8, 8, 1, -8}, {0x1FB8, 2, 1, -8}, {0x1FBA, 2, 1, -74}, {0x1FBC, 1, 1, -9},
+		{0x1FBE, 1, 1, -7173}, {0x1FC8, 4, 1, -86}, {0x1FCC, 1, 1, -9}, {0x1FD8, 2, 1, -8},
+		{0x1FDA, 2, 1, -100}, {0x1FE8, 2, 1, -8}, {0x1FEA, 2, 1, -112}, {0x1FEC, 1, 1, -7},
+		{0x1FF8, 2, 1, -128}, {0x1FFA, 2, 1, -126}, {0x1FFC, 1, 1, -9}, {0x2126, 1, 1, -7517},
+		{0x212A, 1, 1, -8383}, {0x212B, 1, 1, -8262}, {0x2132, 1, 1, 28}, {0x2160, 16, 1, 16},
+		{0x2183, 1, 1, 1}, {0x24B6, 26, 1, 26}, {0x2C00, 48, 1, 48}, {0x2C60, 1, 1, 1},
+		{0x2C62, 1, 1, -10743}, {0x2C63, 1, 1, -3814}, {0x2C64, 1, 1, -10727}, {0x2C67, 3, 2, 1},
+		{0x2C6D, 1, 1, -10780}, {0x2C6E, 1, 1, -10749}, {0x2C6F, 1, 1, -10783}, {0x2C70, 1, 1, -10782},
+		{0x2C72, 1, 1, 1}, {0x2C75, 1, 1, 1}, {0x2C7E, 2, 1, -10815}, {0x2C80, 50, 2, 1},
+		{0x2CEB, 2, 2, 1}, {0x2CF2, 1, 1, 1}, {0xA640, 23, 2, 1}, {0xA680, 14, 2, 1},
+		{0xA722, 7, 2, 1}, {0xA732, 31, 2, 1}, {0xA779, 2, 2, 1}, {0xA77D, 1, 1, -35332},
+		{0xA77E, 5, 2, 1}, {0xA78B, 1, 1, 1}, {0xA78D, 1, 1, -42280}, {0xA790, 2, 2, 1},
+		{0xA796, 10, 2, 1}, {0xA7AA, 1, 1, -42308}, {0xA7AB, 1, 1, -42319}, {0xA7AC, 1, 1, -42315},
+		{0xA7AD, 1, 1, -42305}, {0xA7AE, 1, 1, -42308}, {0xA7B0, 1, 1, -42258}, {0xA7B1, 1, 1, -42282},
+		{0xA7B2, 1, 1, -42261}, {0xA7B3, 1, 1, 928}, {0xA7B4, 8, 2, 1}, {0xA7C4, 1, 1, -48},
+		{0xA7C5, 1, 1, -42307}, {0xA7C6, 1, 1, -35384}, {0xA7C7, 2, 2, 1}, {0xA7D0, 1, 1, 1},
+		{0xA7D6, 2, 2, 1}, {0xA7F5, 1, 1, 1}, {0xAB70, 80, 1, -38864}, {0xFF21, 26, 1, 32},
+		{0x10400, 40, 1, 40}, {0x104B0, 36, 1, 40}, {0x10570, 11, 1, 39}, {0x1057C, 15, 1, 39},
+		{0x1058C, 7, 1, 39}, {0x10594, 2, 1, 39}, {0x10C80, 51, 1, 64}, {0x118A0, 32, 1, 32},
+		{0x16E40, 32, 1, 32}, {0x1E900, 34, 1, 34},
+	};
+	return table;
+}
+
+template<typename Map>
+std::u16string& map_utf16(std::u16string& s, Map map)
+{
+	for(std::size_t i = 0; i < s.size(); ++i)
+	{
+		char32_t cp = s[i];
+
+		if(cp < 0x80)
+			s[i] = char16_t(map(cp));
+		else if(cp >= 0xD800 && cp < 0xDC00 && i + 1 < s.size()
+			&& s[i + 1] >= 0xDC00 && s[i + 1] < 0xE000)
+		{
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (s[i + 1] - 0xDC00u);
+			cp = map(cp) - 0x10000; // simple mappings never leave their plane
+			s[i] = char16_t(0xD800 + (cp >> 10));
+			s[++i] = char16_t(0xDC00 + (cp & 0x3FF));
+		}
+		else if(cp < 0xD800 || cp >= 0xE000)
+			s[i] = char16_t(map(cp));
+	}
+	return s;
+}
+
+template<typename Map>
+std::u32string& map_utf32(std::u32string& s, Map map)
+{
+	for(auto& c: s)
+		c = map(c);
+	return s;
+}
+
+} // namespace detail
+
+//! The simple lowercase mapping of a code point.
+inline char32_t to_lower(char32_t cp)
+{
+	if(cp < 0x80)
+		return cp - U'A' < 26 ? cp + 0x20 : cp;
+	return detail::map_case(detail::lower_table(), cp);
+}
+
+//! The simple uppercase mapping of a code point.
+inline char32_t to_upper(char32_t cp)
+{
+	if(cp < 0x80)
+		return cp - U'a' < 26 ? cp - 0x20 : cp;
+	return detail::map_case(detail::upper_table(), cp);
+}
+
+/**
+ * The simple case folding of a code point. Strings that differ only
+ * by case compare equal after folding, which makes it the right
+ * normalisation for case insensitive keys. Unlike to_lower() it
+ * maps final sigma (U+03C2) to sigma (U+03C3), for example.
+ */
+inline char32_t fold_case(char32_t cp)
+{
+	if(cp < 0x80)
+		return cp - U'A' < 26 ? cp + 0x20 : cp;
+	return detail::map_case(detail::fold_table(), cp);
+}
+
+inline std::u16string& to_lower_mute(std::u16string& s) { return detail::map_utf16(s, to_lower); }
+inline std::u16string& to_upper_mute(std::u16string& s) { return detail::map_utf16(s, to_upper); }
+inline std::u16string& fold_case_mute(std::u16string& s) { return detail::map_utf16(s, fold_case); }
+
+inline std::u32string& to_lower_mute(std::u32string& s) { return detail::map_utf32(s, to_lower); }
+inline std::u32string& to_upper_mute(std::u32string& s) { return detail::map_utf32(s, to_upper); }
+inline std::u32string& fold_case_mute(std::u32string& s) { return detail::map_utf32(s, fold_case); }
+
+} // namespace unicode_utils
+} // namespace header_only_library
+
+#endif // HEADER_ONLY_LIBRARY_UNICODE_CASE_H
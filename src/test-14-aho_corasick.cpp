@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "hol/aho_corasick.h"
+#include "hol/random_numbers.h"
+#include "hol/range.h"
+
+namespace hol{
+	using namespace header_only_library::algorithm;
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::range;
+}
+
+namespace {
+
+// leftmost-longest, non-overlapping, the first of duplicates
+std::vector<hol::aho_corasick::match> brute_force(std::string const& s,
+	std::vector<std::string> const& patterns)
+{
+	std::vector<hol::aho_corasick::match> v;
+
+	for(std::size_t pos = 0; pos < s.size();)
+	{
+		hol::aho_corasick::match best{std::size_t(-1), pos, 0};
+
+		for(std::size_t i = 0; i < patterns.size(); ++i)
+			if(!patterns[i].empty() && patterns[i].size() > best.size
+			&& !s.compare(pos, patterns[i].size(), patterns[i]))
+				best = {i, pos, patterns[i].size()};
+
+		if(best.size)
+		{
+			v.push_back(best);
+			pos += best.size;
+		}
+		else
+			++pos;
+	}
+
+	return v;
+}
+
+// every occurrence, ordered by end then longest first
+std::vector<hol::aho_corasick::match> brute_force_overlapping(std::string const& s,
+	std::vector<std::string> const& patterns)
+{
+	std::vector<hol::aho_corasick::match> v;
+
+	for(std::size_t end = 1; end <= s.size(); ++end)
+		for(std::size_t size = end; size; --size)
+			for(std::size_t i = 0; i < patterns.size(); ++i)
+				if(patterns[i].size() == size && !s.compare(end - size, size, patterns[i]))
+				{
+					v.push_back({i, end - size, size});
+					break;
+				}
+
+	return v;
+}
+
+bool same(std::vector<hol::aho_corasick::match> const& a,
+	std::vector<hol::aho_corasick::match> const& b)
+{
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto const& x, auto const& y)
+		{ return x.pattern == y.pattern && x.pos == y.pos && x.size == y.size; });
+}
+
+} // namespace
+
+TEST_CASE("Aho-Corasick", "[aho_corasick]")
+{
+	SECTION("classic example")
+	{
+		hol::aho_corasick const ac{"he", "she", "his", "hers"};
+
+		auto const m = ac.matches("ushers");
+
+		REQUIRE(m.size() == 1);
+		REQUIRE(m[0].pattern == 1);
+		REQUIRE(m[0].pos == 1);
+		REQUIRE(m[0].size == 3);
+
+		REQUIRE(ac.matches("").empty());
+		REQUIRE(ac.matches("xyz").empty());
+		REQUIRE(hol::aho_corasick{}.matches("abc").empty());
+	}
+
+	SECTION("agrees with brute force")
+	{
+		bool ok = true;
+		for(int i = 0; i < 300; ++i)
+		{
+			std::vector<std::string> patterns(hol::random_number(1, 8));
+			for(auto& p: patterns)
+			{
+				p.resize(hol::random_number(std::size_t(0), std::size_t(4)));
+				for(auto& c: p)
+					c = "abc"[hol::random_number(0, 2)];
+			}
+
+			std::string s(hol::random_number(std::size_t(0), std::size_t(50)), 'a');
+			for(auto& c: s)
+				c = "abcd"[hol::random_number(0, 3)];
+
+			hol::aho_corasick const ac(patterns.begin(), patterns.end());
+			ok = ok && same(ac.matches(s), brute_force(s, patterns));
+			ok = ok && same(ac.overlapping_matches(s), brute_force_overlapping(s, patterns));
+		}
+		REQUIRE(ok);
+	}
+
+	SECTION("overlapping")
+	{
+		hol::aho_corasick const ac{"he", "she", "his", "hers"};
+
+		auto const m = ac.overlapping_matches("ushers");
+
+		REQUIRE(m.size() == 3);
+		REQUIRE(m[0].pattern == 1);
+		REQUIRE(m[1].pattern == 0);
+		REQUIRE(m[1].pos == 2);
+		REQUIRE(m[2].pattern == 3);
+		REQUIRE(m[2].pos == 2);
+	}
+
+	SECTION("ranges")
+	{
+		std::string const s = "xx$a $b $a";
+		hol::aho_corasick const ac{"$a", "$b"};
+
+		// every pattern starts with '$'
+		hol::basic_range<char const> r(s.data(), s.size());
+		auto const m = ac.matches(r);
+
+		REQUIRE(m.size() == 3);
+		REQUIRE(m[0].pos == 2);
+		REQUIRE(m[1].pattern == 1);
+		REQUIRE(m[2].pos == 8);
+		REQUIRE(ac.overlapping_matches(r).size() == 3);
+		REQUIRE(ac.matches(hol::basic_range<char const>(s.data(), std::size_t(0))).empty());
+	}
+
+	SECTION("wide characters")
+	{
+		hol::u32aho_corasick const ac{U"\U0001F600", U"aé"};
+
+		auto const m = ac.matches(U"xaé\U0001F600");
+
+		REQUIRE(m.size() == 2);
+		REQUIRE(m[0].pos == 1);
+		REQUIRE(m[1].pattern == 0);
+		REQUIRE(m[1].pos == 3);
+	}
+}
@@ -0,0 +1,511 @@
+//
+// Copyright (c) 2018 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "hol/from_chars.h"
+#include "hol/random_numbers.h"
+#include "hol/srange_utils.h"
+
+namespace hol {
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::string_conversions;
+}
+
+template<typename Integer>
+using limits = std::numeric_limits<Integer>;
+
+template<typename Integer>
+bool parses_as(std::string const& s, Integer expected)
+{
+	Integer i = 0;
+	auto r = hol::from_chars(s, i);
+	return r.ec == std::errc() && r.ptr == s.data() + s.size() && i == expected;
+}
+
+template<typename Integer>
+bool out_of_range(std::string const& s)
+{
+	Integer i = 7;
+	auto r = hol::from_chars(s, i);
+	return r.ec == std::errc::result_out_of_range && r.ptr == s.data() + s.size() && i == 7;
+}
+
+// the next number past the limit, computed without overflowing
+std::string past(std::string s)
+{
+	std::size_t const first = s[0] == '-';
+
+	auto i = s.size();
+	while(i > first && s[i - 1] == '9')
+		s[--i] = '0';
+
+	if(i == first)
+		s.insert(first, 1, '1');
+	else
+		++s[i - 1];
+
+	return s;
+}
+
+template<typename Integer>
+bool limits_hold()
+{
+	auto const max = std::to_string(limits<Integer>::max());
+	auto const min = std::to_string(limits<Integer>::min());
+
+	return parses_as(max, limits<Integer>::max())
+		&& parses_as(min, limits<Integer>::min())
+		&& out_of_range<Integer>(past(max))
+		&& (!limits<Integer>::is_signed || out_of_range<Integer>(past(min)))
+		&& out_of_range<Integer>(max + "0")
+		&& parses_as("000000000000000000000000" + max, limits<Integer>::max());
+}
+
+TEST_CASE("Integer limits", "[from_chars]")
+{
+	REQUIRE(past("99") == "100");
+	REQUIRE(past("-128") == "-129");
+	REQUIRE(past("-99") == "-100");
+
+	REQUIRE(limits_hold<signed char>());
+	REQUIRE(limits_hold<unsigned char>());
+	REQUIRE(limits_hold<short>());
+	REQUIRE(limits_hold<unsigned short>());
+	REQUIRE(limits_hold<int>());
+	REQUIRE(limits_hold<unsigned int>());
+	REQUIRE(limits_hold<long>());
+	REQUIRE(limits_hold<unsigned long>());
+	REQUIRE(limits_hold<long long>());
+	REQUIRE(limits_hold<unsigned long long>());
+	REQUIRE(limits_hold<std::int8_t>());
+	REQUIRE(limits_hold<std::uint64_t>());
+
+	REQUIRE(out_of_range<std::uint64_t>("99999999999999999999"));
+	REQUIRE(out_of_range<std::uint64_t>("100000000000000000000000000000"));
+}
+
+TEST_CASE("Strict parsing", "[from_chars]")
+{
+	SECTION("every length")
+	{
+		// crosses the eight and sixteen digit chunk boundaries
+		bool ok = true;
+		std::uint64_t expected = 0;
+		std::string s;
+		for(int n = 1; n < 20; ++n)
+		{
+			auto const d = char('1' + n % 9);
+			s += d;
+			expected = expected * 10 + std::uint64_t(d - '0');
+			ok = ok && parses_as(s, expected);
+			ok = ok && parses_as(s + "x", expected) == false;
+
+			std::uint64_t u;
+			auto const t = s + "x1234567";
+			auto r = hol::from_chars(t, u);
+			ok = ok && r.ec == std::errc() && r.ptr == t.data() + s.size() && u == expected;
+		}
+		REQUIRE(ok);
+	}
+
+	SECTION("random")
+	{
+		bool ok = true;
+		for(int i = 0; i < 10000; ++i)
+		{
+			auto const ll = hol::random_number(limits<long long>::min(), limits<long long>::max())
+				>> hol::random_number(0, 62);
+			auto const ull = hol::random_number(std::uint64_t(0), limits<std::uint64_t>::max())
+				>> hol::random_number(0, 63);
+
+			ok = ok && parses_as(std::to_string(ll), ll);
+			ok = ok && parses_as(std::to_string(ull), ull);
+		}
+		REQUIRE(ok);
+	}
+
+	SECTION("rejects")
+	{
+		int i = 7;
+		for(std::string s: {"", "-", "+1", " 1", "x", "-x"})
+		{
+			auto r = hol::from_chars(s, i);
+			REQUIRE(r.ec == std::errc::invalid_argument);
+			REQUIRE(r.ptr == s.data());
+		}
+
+		unsigned u = 7;
+		std::string const neg = "-1";
+		REQUIRE(hol::from_chars(neg, u).ec == std::errc::invalid_argument);
+		REQUIRE(i == 7);
+		REQUIRE(u == 7);
+
+		std::string const hex = "0x1f";
+		auto r = hol::from_chars(hex, i);
+		REQUIRE(r.ec == std::errc());
+		REQUIRE(r.ptr == hex.data() + 1);
+		REQUIRE(i == 0);
+	}
+
+	SECTION("bases")
+	{
+		int i;
+		std::string const s = "-7fffffff";
+		REQUIRE(hol::from_chars(s, i, 16).ec == std::errc());
+		REQUIRE(i == -0x7fffffff);
+
+		std::uint64_t u;
+		std::string const max = "ffffffffffffffff";
+		REQUIRE(hol::from_chars(max, u, 16).ec == std::errc());
+		REQUIRE(u == limits<std::uint64_t>::max());
+		REQUIRE(hol::from_chars(max + "0", u, 16).ec == std::errc::result_out_of_range);
+
+		std::string const zz = "Zz";
+		REQUIRE(hol::from_chars(zz, i, 36).ec == std::errc());
+		REQUIRE(i == 35 * 36 + 35);
+		REQUIRE(hol::from_chars(zz, i, 37).ec == std::errc::invalid_argument);
+	}
+
+	SECTION("wide")
+	{
+		std::u16string const s = u"-12345678901234";
+		long long ll;
+		auto r = hol::from_chars(s, ll);
+		REQUIRE(r.ec == std::errc());
+		REQUIRE(ll == -12345678901234LL);
+
+		// a digit value in the low byte must not be mistaken for a digit
+		std::u32string const t = U"12ĳ";
+		int i;
+		REQUIRE(hol::from_chars(t, i).ptr == t.data() + 2);
+	}
+}
+
+TEST_CASE("Lenient parsing", "[scan_integer]")
+{
+	SECTION("matches strtoll")
+	{
+		char const alphabet[] = " \t+-0123456789xXaf";
+
+		bool ok = true;
+		for(int i = 0; i < 20000; ++i)
+		{
+			std::string s(std::size_t(hol::random_number(0, 24)), ' ');
+			for(auto& c: s)
+				c = alphabet[hol::random_number(std::size_t(0), sizeof(alphabet) - 2)];
+
+			for(int base: {0, 10, 16})
+			{
+				char* end;
+				errno = 0;
+				auto const expected = std::strtoll(s.c_str(), &end, base);
+				auto const range = errno == ERANGE;
+
+				long long ll = 0;
+				auto r = hol::scan_integer(s, ll, base);
+
+				if(end == s.c_str())
+					ok = ok && r.ec == std::errc::invalid_argument && r.ptr == s.data();
+				else if(range)
+					ok = ok && r.ec == std::errc::result_out_of_range && r.ptr == end;
+				else
+					ok = ok && r.ec == std::errc() && r.ptr == end && ll == expected;
+			}
+		}
+		REQUIRE(ok);
+	}
+
+	SECTION("unsigned")
+	{
+		std::string const s = " -1";
+		unsigned long long ull;
+		REQUIRE(hol::scan_integer(s, ull).ec == std::errc());
+		REQUIRE(ull == limits<unsigned long long>::max());
+
+		unsigned u;
+		REQUIRE(hol::scan_integer(s, u).ec == std::errc::result_out_of_range);
+
+		std::string const oct = "0777";
+		REQUIRE(hol::scan_integer(oct, u, 0).ec == std::errc());
+		REQUIRE(u == 0777);
+	}
+
+	SECTION("ranges")
+	{
+		namespace range = header_only_library::range;
+
+		// not null terminated
+		std::string const s = "4000000000123";
+		range::basic_range<char const> r(s.data(), 10);
+
+		std::size_t pos = 0;
+		REQUIRE(range::stol(r, &pos) == 4000000000L);
+		REQUIRE(pos == 10);
+		REQUIRE(range::stoll(r) == 4000000000LL);
+		REQUIRE(range::stoul(r) == 4000000000UL);
+		REQUIRE_THROWS_AS(range::stoi(r), std::out_of_range);
+		REQUIRE_THROWS_AS(range::stoi(range::basic_range<char const>(s.data(), std::size_t(0))), std::invalid_argument);
+	}
+}
+
+template<typename Float, typename Bits>
+Float from_bits(Bits bits)
+{
+	Float f;
+	std::memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+template<typename Float>
+std::string format(Float f)
+{
+	char buf[32];
+	auto r = hol::to_chars(buf, buf + sizeof(buf), f);
+	return {buf, r.ptr};
+}
+
+double strto(std::string const& s, double) { return std::strtod(s.c_str(), nullptr); }
+float strto(std::string const& s, float) { return std::strtof(s.c_str(), nullptr); }
+
+template<typename Float>
+bool round_trips(Float f)
+{
+	auto const s = format(f);
+
+	Float g;
+	auto r = hol::from_chars(s, g);
+
+	return r.ec == std::errc() && r.ptr == s.data() + s.size()
+		&& std::memcmp(&f, &g, sizeof(f)) == 0
+		&& strto(s, f) == f;
+}
+
+TEST_CASE("Floating point parsing", "[from_chars]")
+{
+	SECTION("matches strtod")
+	{
+		bool ok = true;
+		for(int i = 0; i < 20000; ++i)
+		{
+			std::string s;
+			if(hol::random_number(0, 3) == 0)
+				s += '-';
+
+			// long enough to need more than 19 digits sometimes
+			auto const n = hol::random_number(1, 30);
+			auto const dot = hol::random_number(-1, n);
+			for(int j = 0; j < n; ++j)
+			{
+				if(j == dot)
+					s += '.';
+				s += char(hol::random_number(int('0'), int('9')));
+			}
+
+			if(hol::random_number(0, 1))
+				s += "e" + std::to_string(hol::random_number(-330, 300));
+
+			double d = 0;
+			auto r = hol::from_chars(s, d);
+			auto const expected = std::strtod(s.c_str(), nullptr);
+
+			if(std::abs(expected) > std::numeric_limits<double>::max()
+			|| (expected == 0 && s.find_first_of("123456789") < s.find('e')))
+				ok = ok && r.ec == std::errc::result_out_of_range;
+			else
+				ok = ok && r.ec == std::errc() && r.ptr == s.data() + s.size() && d == expected;
+
+			float f = 0;
+			r = hol::from_chars(s, f);
+			ok = ok && (r.ec != std::errc() || f == std::strtof(s.c_str(), nullptr));
+		}
+		REQUIRE(ok);
+	}
+
+	SECTION("halfway")
+	{
+		// exactly between 1 and the next double, and just above it
+		std::string const half = "1.00000000000000011102230246251565404236316680908203125";
+		double d;
+		REQUIRE(hol::from_chars(half, d).ec == std::errc());
+		REQUIRE(d == 1.0);
+		REQUIRE(hol::from_chars(half + "1", d).ec == std::errc());
+		REQUIRE(d == std::nextafter(1.0, 2.0));
+		REQUIRE(hol::from_chars("-" + half + "000000000000000000000000000001", d).ec == std::errc());
+		REQUIRE(d == -std::nextafter(1.0, 2.0));
+	}
+
+	SECTION("special")
+	{
+		double d = 7;
+		std::string const inf = "-Infinity";
+		auto r = hol::from_chars(inf, d);
+		REQUIRE(r.ptr == inf.data() + inf.size());
+		REQUIRE(d == -std::numeric_limits<double>::infinity());
+
+		std::string const nan = "nan(123)x";
+		r = hol::from_chars(nan, d);
+		REQUIRE(r.ptr == nan.data() + 8);
+		REQUIRE(d != d);
+
+		d = 7;
+		for(std::string s: {"", "-", ".", "+1", " 1", "e5", "in"})
+			REQUIRE(hol::from_chars(s, d).ec == std::errc::invalid_argument);
+		REQUIRE(d == 7);
+
+		for(std::string s: {"1e309", "-1e400", "1e-400", "2e-324"})
+			REQUIRE(hol::from_chars(s, d).ec == std::errc::result_out_of_range);
+		REQUIRE(d == 7);
+
+		std::string const part = "1.5e+x";
+		REQUIRE(hol::from_chars(part, d).ptr == part.data() + 3);
+		REQUIRE(d == 1.5);
+
+		REQUIRE(hol::scan_real(std::string(" +2.5"), d).ec == std::errc());
+		REQUIRE(d == 2.5);
+		REQUIRE(hol::scan_real(std::string("+-2.5"), d).ec == std::errc::invalid_argument);
+	}
+}
+
+TEST_CASE("Floating point formatting", "[to_chars]")
+{
+	SECTION("shortest")
+	{
+		REQUIRE(format(0.1) == "0.1");
+		REQUIRE(format(0.3) == "0.3");
+		REQUIRE(format(0.1 + 0.2) == "0.30000000000000004");
+		REQUIRE(format(1.0) == "1");
+		REQUIRE(format(-0.0) == "-0");
+		REQUIRE(format(123456.0) == "123456");
+		REQUIRE(format(1e22) == "1e+22");
+		// equal lengths prefer fixed, padding the shortest digits with zeros
+		REQUIRE(format(std::nextafter(1e21, 2e21)) == "1000000000000000100000");
+		REQUIRE(format(std::nextafter(1e23, 2e23)) == "1.0000000000000001e+23");
+		REQUIRE(format(0.001) == "0.001");
+		REQUIRE(format(0.0001) == "1e-04");
+		REQUIRE(format(0.00001) == "1e-05");
+		REQUIRE(format(1.5e300) == "1.5e+300");
+		REQUIRE(format(5e-324) == "5e-324");
+		REQUIRE(format(std::numeric_limits<double>::max()) == "1.7976931348623157e+308");
+		REQUIRE(format(std::numeric_limits<double>::min()) == "2.2250738585072014e-308");
+		REQUIRE(format(-std::numeric_limits<double>::infinity()) == "-inf");
+		REQUIRE(format(std::numeric_limits<double>::quiet_NaN()) == "nan");
+
+		REQUIRE(format(0.1f) == "0.1");
+		REQUIRE(format(16777216.0f) == "16777216");
+		REQUIRE(format(3.4028235e38f) == "3.4028235e+38");
+		REQUIRE(format(1e-45f) == "1e-45");
+	}
+
+	SECTION("round trip")
+	{
+		bool ok = true;
+		for(int i = 0; i < 20000; ++i)
+		{
+			auto const d = from_bits<double>(hol::random_number(std::uint64_t(0), limits<std::uint64_t>::max()));
+			auto const f = from_bits<float>(hol::random_number(std::uint32_t(0), limits<std::uint32_t>::max()));
+
+			ok = ok && (d != d || round_trips(d));
+			ok = ok && (f != f || round_trips(f));
+		}
+
+		// powers of two have a closer lower neighbour
+		for(int e = 0; e < 2047; ++e)
+			ok = ok && round_trips(from_bits<double>(std::uint64_t(e) << 52));
+
+		REQUIRE(ok);
+	}
+
+	SECTION("buffer size")
+	{
+		char buf[24];
+		auto const d = -2.2250738585072014e-308;
+		REQUIRE(hol::to_chars(buf, buf + 23, d).ec == std::errc::value_too_large);
+		auto r = hol::to_chars(buf, buf + 24, d);
+		REQUIRE(r.ec == std::errc());
+		REQUIRE(std::string(buf, r.ptr) == "-2.2250738585072014e-308");
+	}
+}
+
+TEST_CASE("Batch parsing", "[parse_fields]")
+{
+	SECTION("fields")
+	{
+		std::vector<std::string> fields(130, "7");
+		fields[0] = "-12";
+		fields[3] = "";
+		fields[64] = "3x";
+		fields[129] = "99999999999";
+
+		std::vector<int> out(fields.size(), 0);
+		std::uint64_t errors[3] = {~0ULL, ~0ULL, ~0ULL};
+
+		REQUIRE(hol::parse_fields(fields.begin(), fields.end(), out.data(), errors) == 3);
+		REQUIRE(errors[0] == (1ULL << 3));
+		REQUIRE(errors[1] == 1ULL);
+		REQUIRE(errors[2] == 2ULL);
+		REQUIRE(out[0] == -12);
+		REQUIRE(out[3] == 0);
+		REQUIRE(out[64] == 0);
+		REQUIRE(out[128] == 7);
+
+		std::vector<std::string> hex = {"ff", "10"};
+		unsigned h[2];
+		REQUIRE(hol::parse_fields(hex.begin(), hex.end(), h, errors, 16) == 0);
+		REQUIRE(errors[0] == 0);
+		REQUIRE(h[0] == 255);
+		REQUIRE(h[1] == 16);
+	}
+
+	SECTION("row")
+	{
+		namespace range = header_only_library::range;
+
+		struct { int id; unsigned long count; double price; float rate; } rec = {};
+
+		std::string const line = "42,7,19.99,0.5";
+		auto const fields = range::split(range::make_srange(line), ",");
+
+		REQUIRE(hol::parse_row(fields, rec.id, rec.count, rec.price, rec.rate) == 0);
+		REQUIRE(rec.id == 42);
+		REQUIRE(rec.count == 7);
+		REQUIRE(rec.price == 19.99);
+		REQUIRE(rec.rate == 0.5f);
+
+		std::vector<std::string> bad = {"1", "-", "2.5"};
+		int a = 0, b = 0, c = 0, d = 0;
+		REQUIRE(hol::parse_row(bad, a, b, c, d) == 0xE);
+		REQUIRE(a == 1);
+		REQUIRE(b == 0);
+	}
+}
@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "hol/latency_histogram.h"
+#include "hol/random_numbers.h"
+
+namespace hol {
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::simple_logger;
+	using namespace header_only_library::timers;
+}
+
+TEST_CASE("Latency histogram", "[histogram]")
+{
+	SECTION("bucket boundaries are contiguous")
+	{
+		using h = hol::latency_histogram;
+
+		for(std::size_t i = 1; i < h::bucket_count; ++i)
+			REQUIRE(h::lowest_equivalent(i) == h::highest_equivalent(i - 1) + 1);
+
+		for(std::uint64_t v: {0ULL, 1ULL, 255ULL, 256ULL, 1000ULL, 123456789ULL, ~0ULL})
+		{
+			auto i = h::index_of(v);
+			REQUIRE(i < h::bucket_count);
+			REQUIRE(h::lowest_equivalent(i) <= v);
+			REQUIRE(h::highest_equivalent(i) >= v);
+		}
+	}
+
+	SECTION("percentiles are within bucket resolution")
+	{
+		hol::latency_histogram h;
+
+		std::vector<std::uint64_t> v;
+		std::generate_n(std::back_inserter(v), 100000,
+			[]{ return hol::random_number(std::uint64_t(10), std::uint64_t(10000000)); });
+
+		for(auto ns: v)
+			h.record(ns);
+
+		std::sort(std::begin(v), std::end(v));
+
+		REQUIRE(h.count() == v.size());
+		REQUIRE(h.min() == v.front());
+		REQUIRE(h.max() == v.back());
+
+		for(auto p: {50.0, 90.0, 99.0, 99.9})
+		{
+			auto expected = double(v[std::size_t(p / 100.0 * double(v.size())) - 1]);
+			auto actual = double(h.percentile(p));
+			REQUIRE(actual >= expected * 0.99);
+			REQUIRE(actual <= expected * 1.01);
+		}
+	}
+
+	SECTION("merging per thread histograms")
+	{
+		std::vector<hol::latency_histogram> hs(4);
+		std::vector<std::thread> threads;
+
+		for(auto& h: hs)
+			threads.emplace_back([&h]{
+				for(std::uint64_t i = 1; i <= 1000; ++i)
+					h.record(i);
+			});
+
+		for(auto& t: threads)
+			t.join();
+
+		hol::latency_histogram total;
+
+		for(auto const& h: hs)
+			total.merge(h);
+
+		REQUIRE(total.count() == 4000);
+		REQUIRE(total.min() == 1);
+		REQUIRE(total.max() == 1000);
+		REQUIRE(total.mean() == Approx(500.5));
+	}
+
+	SECTION("recording a scope")
+	{
+		hol::latency_histogram h;
+
+		{
+			auto scope = h.time_scope();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		REQUIRE(h.count() == 1);
+		REQUIRE(h.min() >= 1000000);
+	}
+
+	SECTION("summary")
+	{
+		hol::latency_histogram h;
+
+		h.record(80);
+		h.record(1500);
+		h.record(2000000);
+
+		std::ostringstream oss;
+		hol::log_out::stream(oss);
+		hol::log_out::format_time("");
+		h.log_summary("test");
+		hol::log_out::stream(std::cout);
+
+		REQUIRE(oss.str() == "I: test: n=3 min=80ns mean=667us p50=1.5us p99=2ms p999=2ms max=2ms\n");
+	}
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hol/line_reader.h"
+
+namespace hol{
+	using namespace header_only_library::string_utils;
+}
+
+namespace {
+
+template<typename Reader>
+std::vector<std::string> read_all(Reader& reader)
+{
+	std::vector<std::string> lines;
+	for(auto line: reader)
+		lines.emplace_back(line.begin(), line.end());
+	return lines;
+}
+
+std::string const text =
+	"first line\n"
+	"\n"
+	"a line that is a good deal longer than the tiny buffers below\n"
+	"x\n"
+	"unterminated";
+
+std::vector<std::string> const expected =
+{
+	"first line",
+	"",
+	"a line that is a good deal longer than the tiny buffers below",
+	"x",
+	"unterminated",
+};
+
+} // namespace
+
+TEST_CASE("Line reader", "[line_reader]")
+{
+	SECTION("streambuf with buffers crossing line boundaries")
+	{
+		for(std::size_t size = 1; size < 80; ++size)
+		{
+			std::istringstream iss(text);
+			hol::line_reader reader(iss, size);
+			REQUIRE(read_all(reader) == expected);
+		}
+	}
+
+	SECTION("empty input and trailing delimiter")
+	{
+		std::istringstream empty;
+		hol::line_reader r1(empty, 4);
+		REQUIRE(read_all(r1).empty());
+
+		std::istringstream newline("\n");
+		hol::line_reader r2(newline, 4);
+		REQUIRE(read_all(r2) == std::vector<std::string>{""});
+
+		std::istringstream terminated("a\nb\n");
+		hol::line_reader r3(terminated, 4);
+		REQUIRE(read_all(r3) == (std::vector<std::string>{"a", "b"}));
+	}
+
+	SECTION("custom delimiter and next()")
+	{
+		std::istringstream iss("1,22,,333");
+		hol::line_reader reader(iss, 3, ',');
+
+		hol::line_reader::line_type field;
+		std::vector<std::string> fields;
+		while(reader.next(field))
+			fields.emplace_back(field.begin(), field.end());
+
+		REQUIRE(fields == (std::vector<std::string>{"1", "22", "", "333"}));
+		REQUIRE(!reader.next(field));
+	}
+
+#ifdef __unix__
+	SECTION("files")
+	{
+		std::string const filename = "test-14-line_reader.tmp";
+
+		{
+			std::ofstream ofs(filename, std::ios::binary);
+			for(int i = 0; i < 10000; ++i)
+				ofs << "line " << i << '\n';
+		}
+
+		hol::line_reader reader(filename, 64);
+
+		int i = 0;
+		bool ok = true;
+		for(auto line: reader)
+			ok = ok && std::string(line.begin(), line.end()) == "line " + std::to_string(i++);
+
+		REQUIRE(ok);
+		REQUIRE(i == 10000);
+
+		std::remove(filename.c_str());
+
+		REQUIRE_THROWS_AS(hol::line_reader(filename), std::runtime_error);
+	}
+#endif
+}
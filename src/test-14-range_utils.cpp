@@ -25,7 +25,7 @@
 
 //#include <algorithm>
 #include <string>
-//#include <vector>
+#include <vector>
 
 //#include "test.h"
 #include "hol/bug.h"
@@ -226,6 +226,23 @@ TEST_CASE("Regex operations", "[]")
 			}
 		}
 	}
+
+	SECTION("literal_search_all")
+	{
+		std::string s = "the cat sat on the concatenation";
+		header_only_library::algorithm::aho_corasick const ac{"cat", "on", "concat"};
+
+		auto matches = hol::literal_search_all(hol::make_range(s), ac);
+
+		std::vector<std::string> answers = {"cat", "on", "concat", "on"};
+
+		REQUIRE(matches.size() == answers.size());
+		for(auto i = 0U; i < matches.size(); ++i)
+			REQUIRE(std::string(matches[i].begin(), matches[i].end()) == answers[i]);
+
+		REQUIRE(matches[0].data() == s.data() + 4);
+		REQUIRE(hol::literal_search_all(hol::make_range(s), ac, true).size() == 6);
+	}
 }
 
 TEST_CASE("Algorithms", "[]")
@@ -327,3 +344,65 @@ TEST_CASE("Algorithms", "[]")
 		REQUIRE(*p.second == 9);
 	}
 }
+
+TEST_CASE("Lazy splitting", "[split_view]")
+{
+	auto pieces = [](auto&& view)
+	{
+		std::vector<std::string> v;
+		for(auto piece: view)
+			v.push_back(piece.string());
+		return v;
+	};
+
+	SECTION("split_view agrees with split")
+	{
+		std::vector<std::string> const texts = {"", "||", "||||", "some||text||to||split", "||text", "text||", "text"};
+
+		for(auto const& s: texts)
+		{
+			std::vector<std::string> x;
+			for(auto r: hol::split(hol::make_srange(s), "||"))
+				x.push_back(r.string());
+
+			REQUIRE(pieces(hol::split_view(s, "||")) == x);
+		}
+
+		REQUIRE(pieces(hol::split_view(hol::make_srange("a b  c"))) == (std::vector<std::string>{"a", "b", "", "c"}));
+	}
+
+	SECTION("pieces refer into the original string")
+	{
+		std::string s = "abc,def,ghi";
+
+		auto v = hol::split_view(hol::make_srange(s), ",");
+		auto i = v.begin();
+
+		REQUIRE(i->data() == s.data());
+		++i;
+		REQUIRE(i->data() == s.data() + 4);
+		auto piece = *i;
+		piece[0] = 'D';
+		REQUIRE(s == "abc,Def,ghi");
+	}
+
+	SECTION("early termination and split_n")
+	{
+		std::string const s = "a,b,c,d,e";
+
+		REQUIRE(pieces(hol::split_n(s, ",", 0)).empty());
+		REQUIRE(pieces(hol::split_n(s, ",", 3)) == (std::vector<std::string>{"a", "b", "c"}));
+		REQUIRE(pieces(hol::split_n(s, ",", 9)) == (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+
+		REQUIRE(std::next(hol::split_n(s, ",", 3).begin(), 2)->string() == "c");
+
+		std::size_t seen = 0;
+		for(auto piece: hol::split_view(s, ","))
+		{
+			++seen;
+			if(piece.string() == "b")
+				break;
+		}
+		REQUIRE(seen == 2);
+	}
+}
@@ -24,6 +24,10 @@
 #include "catch.hpp"
 
 //#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 //#include "test.h"
@@ -71,6 +75,12 @@ TEST_CASE("String operations", "[]")
 
 		for(auto i = 0; i < 1000; ++i)
 		{
+			if(s.empty())
+			{
+				r = text;
+				s = text;
+			}
+
 			switch(hol::random_number(3))
 			{
 				case 0:
@@ -96,7 +106,7 @@ TEST_CASE("String operations", "[]")
 					auto text = random_text(hol::random_number(100));
 					auto pos = hol::random_number(s.size() - 1);
 
-//					r.insert(std::next(std::begin(s), pos), std::begin(text), std::end(text));
+					r.insert(std::next(std::begin(r), pos), std::begin(text), std::end(text));
 					s.insert(std::next(std::begin(s), pos), std::begin(text), std::end(text));
 					break;
 				}
@@ -105,8 +115,381 @@ TEST_CASE("String operations", "[]")
 			}
 		}
 
-//		REQUIRE(s1 == s2);
-//		REQUIRE_FALSE(s1 != s2);
+		REQUIRE(r.string() == s);
+	}
+
+}
+
+TEST_CASE("Tree operations", "[]")
+{
+	SECTION("edits match std::string")
+	{
+		auto text = random_text(100000);
+
+		hol::rope r = text;
+		std::string s = text;
+
+		for(auto i = 0; i < 2000; ++i)
+		{
+			auto pos = hol::random_number(s.size());
+
+			switch(hol::random_number(4))
+			{
+				case 0:
+				{
+					auto text = random_text(hol::random_number(3000));
+					r.insert(pos, text);
+					s.insert(pos, text);
+					break;
+				}
+				case 1:
+				{
+					auto n = hol::random_number(2000UL);
+					r.erase(pos, n);
+					s.erase(pos, n);
+					break;
+				}
+				case 2:
+				{
+					auto n = hol::random_number(1UL, 5UL);
+					r.insert(pos, n, 'x');
+					s.insert(pos, n, 'x');
+					break;
+				}
+				case 3:
+				{
+					auto n = hol::random_number(50000UL);
+					r = r.substr(0, pos) + r.substr(pos, n) + r.substr(pos);
+					s = s.substr(0, pos) + s.substr(pos, n) + s.substr(pos);
+					break;
+				}
+				case 4:
+				{
+					auto n = hol::random_number(50000UL);
+					r = r.substr(pos, n);
+					s = s.substr(pos, n);
+					if(s.size() < 1000)
+					{
+						r.append(text);
+						s.append(text);
+					}
+					break;
+				}
+			}
+
+			REQUIRE(r.size() == s.size());
+		}
+
+		REQUIRE(r.string() == s);
+		REQUIRE(std::equal(r.begin(), r.end(), s.begin(), s.end()));
+
+		for(auto i = 0; i < 100; ++i)
+		{
+			auto pos = hol::random_number(s.size() - 1);
+			REQUIRE(r[pos] == s[pos]);
+		}
+	}
+
+	SECTION("copies share structure")
+	{
+		hol::rope r(1000000, 'a');
+		auto c = r;
+
+		r.insert(500000, "bcd");
+		r.push_back('e');
+
+		REQUIRE(c.size() == 1000000);
+		REQUIRE(c.string() == std::string(1000000, 'a'));
+		REQUIRE(r.size() == 1000004);
+		REQUIRE(r.substr(499999, 5).string() == "abcda");
+		REQUIRE(r.back() == 'e');
+	}
+
+	SECTION("typing does not fragment leaves")
+	{
+		hol::rope r;
+		std::string s;
+
+		for(auto i = 0; i < 10000; ++i)
+		{
+			auto c = char('a' + i % 26);
+			r.push_back(c);
+			s.push_back(c);
+		}
+
+		REQUIRE(r == hol::rope(s));
+		REQUIRE(r.compare(s) == 0);
+		REQUIRE(r.compare("b") < 0);
+		REQUIRE(hol::rope("abd").compare("abc") > 0);
+		REQUIRE("abc"_r < "abd"_r);
+	}
+
+	SECTION("bounds")
+	{
+		hol::rope r = "abc";
+		REQUIRE_THROWS_AS(r.substr(4), std::out_of_range);
+		REQUIRE_THROWS_AS(r.at(3), std::out_of_range);
+		REQUIRE_THROWS_AS(r.insert(4, "x"), std::out_of_range);
+		REQUIRE(r.erase(1).string() == "a");
+	}
+}
+
+TEST_CASE("Versions", "[]")
+{
+	SECTION("snapshots are unaffected by later edits")
+	{
+		hol::rope r = "the quick brown fox";
+		auto v1 = r.snapshot();
+
+		r.insert(4, "very ");
+		auto v2 = r.snapshot();
+
+		r.erase(0, 4);
+
+		REQUIRE(v1.string() == "the quick brown fox");
+		REQUIRE(v2.string() == "the very quick brown fox");
+		REQUIRE(r.string() == "very quick brown fox");
+
+		REQUIRE(v2.same_version(v2.snapshot()));
+		REQUIRE_FALSE(v2.same_version(r));
+	}
+
+	SECTION("undo and redo")
+	{
+		hol::rope_history history{"abc"_r, 2};
+
+		for(auto c: {'d', 'e', 'f'})
+		{
+			auto r = history.current();
+			r.push_back(c);
+			history.commit(r);
+		}
+
+		REQUIRE(history.current().string() == "abcdef");
+		REQUIRE(history.undo_depth() == 2);
+
+		REQUIRE(history.undo());
+		REQUIRE(history.undo());
+		REQUIRE_FALSE(history.undo());
+		REQUIRE(history.current().string() == "abcd");
+
+		REQUIRE(history.redo());
+		REQUIRE(history.current().string() == "abcde");
+
+		history.commit("xyz"_r);
+		REQUIRE_FALSE(history.can_redo());
+		REQUIRE(history.undo());
+		REQUIRE(history.current().string() == "abcde");
+	}
+
+	SECTION("readers keep their version while the writer edits")
+	{
+		hol::rope r(100000, 'a');
+		auto version = r.snapshot();
+
+		bool unchanged = true;
+
+		std::thread reader([version, &unchanged]{
+			for(auto i = 0; i < 20; ++i)
+			{
+				unchanged = unchanged && version.size() == 100000
+					&& std::all_of(version.begin(), version.end(), [](char c){ return c == 'a'; });
+			}
+		});
+
+		for(auto i = 0; i < 2000; ++i)
+		{
+			r.insert(hol::random_number(r.size()), "b");
+			r.erase(hol::random_number(r.size() - 1), 1);
+		}
+
+		reader.join();
+
+		REQUIRE(unchanged);
+		REQUIRE(r.size() == 100000);
+		REQUIRE(version.string() == std::string(100000, 'a'));
+	}
+}
+
+TEST_CASE("Chunks", "[]")
+{
+	auto text = random_text(10000);
+
+	hol::rope r;
+	for(std::size_t pos = 0; pos < text.size(); pos += 700)
+		r += hol::rope(text.substr(pos, 700));
+
+	SECTION("chunks cover the text in order")
+	{
+		std::string s;
+		std::size_t count = 0;
+
+		for(auto chunk: r.chunks())
+		{
+			REQUIRE_FALSE(chunk.empty());
+			s.append(chunk.data(), chunk.size());
+			++count;
+		}
+
+		REQUIRE(s == text);
+		REQUIRE(count > 1);
+
+		s.clear();
+		for(auto chunk: r.chunks(1234, 5000))
+			s.append(chunk.data(), chunk.size());
+
+		REQUIRE(s == text.substr(1234, 5000));
+
+		std::string copied(100, '\0');
+		REQUIRE(r.copy(&copied[0], 100, 9950) == 50);
+		REQUIRE(copied.substr(0, 50) == text.substr(9950));
+	}
+
+	SECTION("find across chunk boundaries")
+	{
+		for(std::size_t pos: {0UL, 699UL, 1398UL, 5000UL, 9990UL})
+		{
+			auto needle = text.substr(pos, 10);
+			REQUIRE(r.find(needle) == text.find(needle));
+			REQUIRE(r.find(needle, pos) == pos);
+		}
+
+		REQUIRE(r.find('a', 500) == text.find('a', 500));
+		REQUIRE(r.find("not in there") == hol::rope::npos);
+		REQUIRE(r.find("", 10000) == 10000);
+		REQUIRE(r.find('A', 10000) == hol::rope::npos);
 	}
 
+	SECTION("compare and stream by chunk")
+	{
+		hol::rope flat = text;
+
+		REQUIRE(r == flat);
+		REQUIRE(r.compare(text) == 0);
+		REQUIRE(r.compare(text.substr(0, 9999)) > 0);
+		REQUIRE(r.compare(text + "A") < 0);
+
+		auto edited = r;
+		edited.insert(9000, "a");
+		REQUIRE(edited.compare(r) > 0);
+		REQUIRE(r.compare(edited) < 0);
+
+		std::ostringstream oss;
+		oss << r;
+		REQUIRE(oss.str() == text);
+	}
 }
+
+TEST_CASE("Lines", "[]")
+{
+	SECTION("offsets and lines")
+	{
+		std::string text;
+		std::vector<std::size_t> starts;
+
+		for(auto i = 0; i < 2000; ++i)
+		{
+			starts.push_back(text.size());
+			text += random_text(hol::random_number(80)) + '\n';
+		}
+		starts.push_back(text.size());
+
+		auto half = text.size() / 2;
+		hol::rope r = hol::rope(text.substr(0, half)) + hol::rope(text.substr(half));
+
+		REQUIRE(r.line_count() == starts.size());
+
+		for(auto i = 0; i < 200; ++i)
+		{
+			auto line = hol::random_number(starts.size() - 1);
+			REQUIRE(r.line_to_offset(line) == starts[line]);
+
+			auto pos = hol::random_number(text.size());
+			auto expected = std::size_t(std::count(text.begin(), text.begin() + pos, '\n'));
+			REQUIRE(r.offset_to_line(pos) == expected);
+		}
+
+		REQUIRE(r.line(5).string() + '\n' == text.substr(starts[5], starts[6] - starts[5]));
+		REQUIRE(r.line(starts.size() - 1).empty());
+		REQUIRE_THROWS_AS(r.line_to_offset(starts.size()), std::out_of_range);
+	}
+
+	SECTION("UTF-8 columns")
+	{
+		// "añb\n€x\n" - ñ is 2 bytes, € is 3 bytes
+		hol::rope r = "a\xC3\xB1" "b\n\xE2\x82\xAC" "x\n";
+
+		REQUIRE(r.size() == 10);
+		REQUIRE(r.code_points() == 7);
+		REQUIRE(r.line_count() == 3);
+
+		auto lc = r.offset_to_line_column(3);
+		REQUIRE(lc.line == 0);
+		REQUIRE(lc.column == 2);
+
+		lc = r.offset_to_line_column(8);
+		REQUIRE(lc.line == 1);
+		REQUIRE(lc.column == 1);
+
+		REQUIRE(r.line_column_to_offset(0, 2) == 3);
+		REQUIRE(r.line_column_to_offset(1, 1) == 8);
+		REQUIRE(r.line_column_to_offset(1, 10) == 9);
+		REQUIRE(r.line_column_to_offset(2, 0) == 10);
+	}
+}
+
+#ifdef __unix__
+
+TEST_CASE("Mapped files", "[]")
+{
+	std::string const filename = "test-14-rope.tmp";
+	auto text = random_text(200000) + "\nend\n";
+
+	{
+		std::ofstream ofs(filename, std::ios::binary);
+		ofs << text;
+	}
+
+	auto slurp = [&]{
+		std::ifstream ifs(filename, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(ifs), {});
+	};
+
+	SECTION("map, edit and save over the mapped file")
+	{
+		auto r = hol::rope::map_file(filename);
+
+		REQUIRE(r.size() == text.size());
+		REQUIRE(r == hol::rope(text));
+		REQUIRE(r.line_count() == 3);
+
+		auto original = r.snapshot();
+
+		r.insert(100000, "inserted");
+		r.erase(0, 10);
+		text.insert(100000, "inserted");
+		text.erase(0, 10);
+
+		r.save(filename);
+
+		REQUIRE(slurp() == text);
+		REQUIRE(original.size() == text.size() + 2);
+		REQUIRE(original.find("\nend\n") == original.size() - 5);
+	}
+
+	SECTION("empty files")
+	{
+		std::ofstream(filename, std::ios::binary);
+		auto r = hol::rope::map_file(filename);
+		REQUIRE(r.empty());
+
+		hol::rope("abc").save(filename);
+		REQUIRE(slurp() == "abc");
+	}
+
+	std::remove(filename.c_str());
+
+	REQUIRE_THROWS_AS(hol::rope::map_file(filename), std::runtime_error);
+}
+
+#endif // __unix__
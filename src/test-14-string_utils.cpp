@@ -24,12 +24,17 @@
 #include "catch.hpp"
 
 #include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 //#include "test.h"
 #include "hol/bug.h"
 #include "hol/random_numbers.h"
+#include "hol/srange_utils.h"
 #include "hol/string_utils.h"
 #include "hol/unicode_utils.h"
 
@@ -245,6 +250,150 @@ TEST_CASE("Trimming Utils", "[trimming]")
 //		B "{ {} }" " {} "
 //		B " {{}} " " {{}} "
 
+	SECTION("vectorized trimming agrees with find_first_not_of")
+	{
+		std::string const ws = " \t\n\r\f\v";
+
+		auto reference = [&](std::string const& s)
+		{
+			auto const b = s.find_first_not_of(ws);
+			if(b == std::string::npos)
+				return std::string();
+			return s.substr(b, s.find_last_not_of(ws) + 1 - b);
+		};
+
+		bool ok = true;
+		for(int i = 0; i < 2000; ++i)
+		{
+			// long runs of whitespace either side of a short body
+			std::string s;
+			for(auto n = hol::random_number(0, 70); n--;)
+				s += ws[hol::random_number(std::size_t(0), ws.size() - 1)];
+			for(auto n = hol::random_number(0, 3); n--;)
+				s += "a \x80"[hol::random_number(0, 2)];
+			for(auto n = hol::random_number(0, 70); n--;)
+				s += ws[hol::random_number(std::size_t(0), ws.size() - 1)];
+
+			auto const x = reference(s);
+
+			auto m = s;
+			auto k = s;
+			auto const kept = hol::trim_keep(k);
+
+			ok = ok && hol::trim_copy(s) == x;
+			ok = ok && hol::trim_mute(m) == x;
+			ok = ok && k == x && kept.left + k + kept.right == s;
+			m = s;
+			auto const prefix = hol::trim_left_keep(m);
+			ok = ok && prefix + m == s && m == hol::trim_left_copy(s);
+			ok = ok && hol::trim_right_copy(s, ws) == s.substr(0, s.find_last_not_of(ws) + 1);
+			ok = ok && header_only_library::range::trim(
+				header_only_library::range::make_range(s.data(), s.size())).size() == x.size();
+		}
+
+		REQUIRE(ok);
+	}
+}
+
+TEST_CASE("Replacing Utils", "[replace]")
+{
+	SECTION("replace_all")
+	{
+		// the original find/replace loop
+		auto reference = [](std::string s, std::string const& from, std::string const& to)
+		{
+			for(std::size_t pos = 0; (pos = s.find(from, pos)) != std::string::npos; pos += to.size())
+				s.replace(pos, from.size(), to);
+			return s;
+		};
+
+		std::vector<std::pair<std::string, std::string>> const rules =
+			{{"a", "b"}, {"ab", "x"}, {"ab", ""}, {"aa", "aaa"}, {"b", "abab"}};
+
+		bool ok = true;
+		for(int i = 0; i < 500; ++i)
+		{
+			std::string s(hol::random_number(std::size_t(0), std::size_t(60)), 'a');
+			for(auto& c: s)
+				c = "ab"[hol::random_number(0, 1)];
+
+			for(auto const& r: rules)
+			{
+				auto m = s;
+				ok = ok && hol::replace_all_mute(m, r.first, r.second) == reference(s, r.first, r.second);
+				ok = ok && hol::replace_all_copy(s, r.first, r.second) == m;
+			}
+		}
+		REQUIRE(ok);
+
+		auto e = "abc"s;
+		REQUIRE(hol::replace_all_mute(e, ""s, "x"s) == "abc");
+
+		auto w = L"one two two"s;
+		REQUIRE(hol::replace_all_mute(w, L"two"s, L"2"s) == L"one 2 2");
+	}
+
+	SECTION("multiple patterns")
+	{
+		hol::replacer const escape{{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}};
+
+		REQUIRE(escape("<a href=\"x&y\">") == "&lt;a href=&quot;x&amp;y&quot;&gt;");
+		REQUIRE(escape("") == "");
+		REQUIRE(escape("plain") == "plain");
+
+		// leftmost then longest, never rescanning replacements
+		REQUIRE(hol::replace_all_copy("abcd"s, {{"bc", "1"}, {"abc", "2"}, {"cd", "3"}}) == "2d");
+		REQUIRE(hol::replace_all_copy("abcd"s, {{"bcd", "1"}, {"ab", "2"}}) == "2cd");
+		REQUIRE(hol::replace_all_copy("aaaa"s, {{"a", "aa"}, {"aa", "b"}}) == "bb");
+
+		auto s = "{name} is {age}"s;
+		REQUIRE(hol::replace_all_mute(s, {{"{name}", "Bob"}, {"{age}", "42"}}) == "Bob is 42");
+
+		hol::u32replacer const u{{U"\u00e9", U"e"}};
+		REQUIRE(u(U"caf\u00e9") == U"cafe");
+	}
+}
+
+TEST_CASE("Case Utils", "[case]")
+{
+	SECTION("ascii")
+	{
+		auto reference = [](std::string s, char lo, char hi)
+		{
+			for(auto& c: s)
+				if(c >= lo && c <= hi)
+					c ^= 0x20;
+			return s;
+		};
+
+		bool ok = true;
+		for(std::size_t n = 0; n < 100; ++n)
+		{
+			std::string s(n, '\0');
+			for(auto& c: s)
+				c = char(hol::random_number(-128, 127));
+
+			ok = ok && hol::ascii_lower_copy(s) == reference(s, 'A', 'Z');
+			ok = ok && hol::ascii_upper_copy(s) == reference(s, 'a', 'z');
+		}
+		REQUIRE(ok);
+
+		REQUIRE(hol::ascii_lower_copy("Hello, WORLD @[`{ \xC3\x89"s) == "hello, world @[`{ \xC3\x89");
+		REQUIRE(hol::ascii_upper_copy("Hello, WORLD @[`{ \xC3\xA9"s) == "HELLO, WORLD @[`{ \xC3\xA9");
+		REQUIRE(hol::lower_copy("MiXeD"s) == "mixed");
+	}
+
+	SECTION("unicode")
+	{
+		REQUIRE(hol::lower_copy(u"\u0391\u03A3\u00C9\u0130"s) == u"\u03B1\u03C3\u00E9i");
+		REQUIRE(hol::upper_copy(u"\u03B1\u03C3\u03C2\u00FF"s) == u"\u0391\u03A3\u03A3\u0178");
+		REQUIRE(hol::fold_copy(u"\u03A3\u03C3\u03C2"s) == u"\u03C3\u03C3\u03C3");
+
+		// surrogate pairs (Deseret) and an unpaired surrogate
+		REQUIRE(hol::lower_copy(u"\U00010400x\xD801"s) == u"\U00010428x\xD801");
+		REQUIRE(hol::upper_copy(U"\U00010428\u0101"s) == U"\U00010400\u0100");
+		REQUIRE(hol::fold_copy(U"Stra\u1E9Ee"s) == U"stra\u00DFe");
+	}
 }
 
 TEST_CASE("Output Utils", "[output_separator]")
@@ -273,6 +422,58 @@ TEST_CASE("Output Utils", "[output_separator]")
 		REQUIRE(oss.str() == "0, 1, 2");
 	}
 
+	SECTION("appending")
+	{
+		hol::output_separator sep{", "};
+		std::string out;
+
+		for(auto s: {"a", "b", "c"})
+			out += sep, out += s;
+
+		REQUIRE(out == "a, b, c");
+
+		auto copy = sep;
+		copy.reset();
+		REQUIRE(std::string("x") + copy + "y" == "xy");
+		REQUIRE(std::string("x") + copy + "y" == "x, y");
+	}
+
+	SECTION("join_into")
+	{
+		std::vector<std::string> const v{"a", "bc", "", "d"};
+
+		std::string out = "<";
+		REQUIRE(hol::join_into(out, v, ", ") == "<a, bc, , d");
+
+		out.clear();
+		REQUIRE(hol::join_into(out, std::begin(v), std::begin(v), ", ").empty());
+		REQUIRE(hol::join_into(out, v, '|') == "a|bc||d");
+
+		std::vector<char const*> const p{"x", "yz"};
+		out.clear();
+		REQUIRE(hol::join_into(out, p, std::string("--")) == "x--yz");
+
+		// single pass input
+		std::istringstream iss("one two three");
+		out.clear();
+		hol::join_into(out, std::istream_iterator<std::string>(iss), {}, '+');
+		REQUIRE(out == "one+two+three");
+
+		// ranges straight from a lazy split
+		std::string const csv = "1,22,,333";
+		out.clear();
+		hol::join_into(out, header_only_library::range::split_view(csv, ","), " | ");
+		REQUIRE(out == "1 | 22 |  | 333");
+
+		oss.str("");
+		hol::join_into(oss, v, "; ") << '.';
+		REQUIRE(oss.str() == "a; bc; ; d.");
+
+		REQUIRE(hol::join(std::begin(v), std::end(v), ",") == "a,bc,,d");
+		REQUIRE(hol::join(v, std::string("-")) == "a-bc--d");
+		REQUIRE(hol::join(std::vector<std::wstring>{L"a", L"b"}) == L"ab");
+	}
+
 //	SECTION("constructor two param")
 //	{
 //		hol::output_separator sep{"[", ", "};
@@ -367,7 +568,193 @@ TEST_CASE("Splitting Utils", "[split ref types]")
 			REQUIRE(r == x);
 		}
 	}
+
+	SECTION("vectorized split agrees with std::search")
+	{
+		// std::deque iterators are not contiguous so they
+		// take the original std::search path
+		auto reference = [](std::string const& s, std::string const& t, bool fold)
+		{
+			std::deque<char> ds(s.begin(), s.end());
+			std::deque<char> dt(t.begin(), t.end());
+			std::vector<std::string> v;
+			if(fold)
+				header_only_library::algorithm::split_fold(ds.begin(), ds.end(), dt.begin(), dt.end(),
+					header_only_library::algorithm::inserter(v));
+			else
+				header_only_library::algorithm::split(ds.begin(), ds.end(), dt.begin(), dt.end(),
+					header_only_library::algorithm::inserter(v));
+			return v;
+		};
+
+		std::vector<std::string> const delims = {",", "\t", "ab", "aa", "a,a", "aaa", "abababababababababab"};
+
+		bool ok = true;
+		for(int i = 0; i < 2000; ++i)
+		{
+			std::string s(hol::random_number(std::size_t(0), std::size_t(100)), 'a');
+			for(auto& c: s)
+				c = "ab,\t"[hol::random_number(0, 3)];
+
+			for(auto const& t: delims)
+			{
+				ok = ok && hol::split(s, t) == reference(s, t, false);
+				ok = ok && hol::split_fold(s, t) == reference(s, t, true);
+			}
+		}
+
+		REQUIRE(ok);
+
+		std::string const s(1000, 'a');
+		REQUIRE(hol::split(s, "aa").size() == 501);
+		REQUIRE(hol::split(s, std::string(999, 'a')) == (std::vector<std::string>{"", "a"}));
+	}
+
+	SECTION("split_from a set of delimiters")
+	{
+		std::string const s = "a,b;;c d,";
+
+		REQUIRE(hol::split_from(s, ",; ") == (std::vector<std::string>{"a", "b", "", "c", "d", ""}));
+		REQUIRE(hol::split_from_fold(s, ",; ") == (std::vector<std::string>{"a", "b", "c", "d"}));
+		REQUIRE(hol::split_from(std::string(), ",").empty());
+		REQUIRE(hol::split_from(std::string("abc"), ",") == std::vector<std::string>{"abc"});
+
+		auto const r = header_only_library::range::split_from_fold(
+			header_only_library::range::make_srange(s), ",; ");
+		REQUIRE(r.size() == 4);
+		REQUIRE(r[3].data() == s.data() + 7);
+
+		// compare the vectorized (ASCII) and table (non-ASCII) searches
+		// against a plain scan across block boundaries
+		for(auto const& delims: {std::string(",\t "), std::string("\x7f\x80,"), std::string("\xff|")})
+		{
+			header_only_library::algorithm::char_set const set(delims);
+
+			bool ok = true;
+			for(int i = 0; i < 500; ++i)
+			{
+				std::string t(hol::random_number(std::size_t(0), std::size_t(80)), 'x');
+				for(auto& c: t)
+					c = char(hol::random_number(0, 255));
+
+				auto const e = t.data() + t.size();
+				auto const x = std::find_first_of(t.data(), e, delims.begin(), delims.end());
+				auto const y = std::find_if(t.data(), e,
+					[&](char c){ return delims.find(c) == std::string::npos; });
+
+				ok = ok && set.find_first_of(t.data(), e) == x;
+				ok = ok && set.find_first_not_of(t.data(), e) == y;
+			}
+			REQUIRE(ok);
+		}
+
+		std::u32string const w = U"a\u2028b c";
+		REQUIRE(hol::split_from(w, U"\u2028 ") == (std::vector<std::u32string>{U"a", U"b", U"c"}));
+	}
 }
 
 
 
+
+#ifdef __unix__
+
+TEST_CASE("Mapped stencil", "[mapped_stencil]")
+{
+	hol::mapped_stencil ms;
+	ms.compile("${c}some text to ${a} test ${a}${b} done", std::vector<std::string>{"${a}", "${b}", "${c}", "${z}"});
+
+	SECTION("dict")
+	{
+		hol::mapped_stencil::dict const d = {{"${a}", "A"}, {"${b}", "Beeeef"}, {"${c}", "C"}};
+		REQUIRE(ms.create(d) == "Csome text to A test ABeeeef done");
+
+		std::ostringstream oss;
+		ms.create(d, oss);
+		REQUIRE(oss.str() == "Csome text to A test ABeeeef done");
+
+		// missing entries are removed
+		REQUIRE(ms.create({{"${a}", "A"}}) == "some text to A test A done");
+	}
+
+	SECTION("slots")
+	{
+		REQUIRE(ms.slot_count() == 4);
+		REQUIRE(ms.slot("${b}") == 1);
+		REQUIRE(ms.slot("${x}") == std::string::npos);
+
+		std::vector<std::string> values = {"1", "22", "333", "unused"};
+		REQUIRE(ms.size(values) == ms.render(values).size());
+		REQUIRE(ms.render(values) == "333some text to 1 test 122 done");
+
+		std::string buf = "> ";
+		ms.render_into(buf, values);
+		REQUIRE(buf == "> 333some text to 1 test 122 done");
+
+		// copies own their text
+		auto copy = ms;
+		ms.clear();
+		char const* cvalues[] = {"a", "b", "c", ""};
+		REQUIRE(copy.render(cvalues) == "csome text to a test ab done");
+	}
+
+	SECTION("edges")
+	{
+		hol::mapped_stencil plain;
+		plain.compile("no vars", std::vector<std::string>{"${a}"});
+		REQUIRE(plain.render(std::vector<std::string>{"x"}) == "no vars");
+
+		// the earlier of two overlapping matches wins
+		hol::mapped_stencil overlap;
+		overlap.compile("xaab", std::vector<std::string>{"ab", "aa"});
+		REQUIRE(overlap.render(std::vector<std::string>{"1", "2"}) == "x2b");
+	}
+}
+
+TEST_CASE("Mapped files", "[mapped_file]")
+{
+	std::string const filename = "test-14-string_utils.tmp";
+
+	{
+		std::ofstream ofs(filename, std::ios::binary);
+		ofs << "id,value\n1,-42\n2,17\n3,123456";
+	}
+
+	SECTION("split and convert without copying")
+	{
+		auto mf = hol::load_file_mapped(filename, hol::mapped_file::sequential|hol::mapped_file::willneed);
+
+		REQUIRE(mf.size() == 28);
+		REQUIRE(std::string(mf.begin(), mf.end()) == "id,value\n1,-42\n2,17\n3,123456");
+
+		auto lines = header_only_library::range::split(mf.as_srange(), "\n");
+		REQUIRE(lines.size() == 4);
+		REQUIRE(lines[0].data() == mf.data());
+
+		std::vector<int> values;
+		for(std::size_t i = 1; i < lines.size(); ++i)
+		{
+			auto fields = header_only_library::range::split(lines[i], ",");
+			REQUIRE(fields.size() == 2);
+			values.push_back(header_only_library::range::stoi(fields[1]));
+		}
+
+		REQUIRE(values == (std::vector<int>{-42, 17, 123456}));
+	}
+
+	SECTION("moves and empty files")
+	{
+		hol::mapped_file mf{filename};
+		auto moved = std::move(mf);
+		REQUIRE(mf.empty());
+		REQUIRE(moved.size() == 28);
+
+		std::ofstream(filename, std::ios::binary);
+		REQUIRE(hol::mapped_file{filename}.empty());
+	}
+
+	std::remove(filename.c_str());
+
+	REQUIRE_THROWS_AS(hol::mapped_file{filename}, std::runtime_error);
+}
+
+#endif // __unix__
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "hol/text_template.h"
+
+namespace hol{
+	using namespace header_only_library::string_utils;
+}
+
+TEST_CASE("Substitution", "[text_template]")
+{
+	hol::text_template t{"Hi ${name}, ${ name }! ${missing}$${name} $5"};
+
+	REQUIRE(t.slot_count() == 2);
+	REQUIRE(t.slot("name") == 0);
+	REQUIRE(t.slot("nope") == std::string::npos);
+
+	hol::text_template::data d{t};
+	d.set("name", "Bob").set("unknown", "ignored");
+
+	REQUIRE(t.render(d) == "Hi Bob, Bob! ${name} $5");
+
+	SECTION("reuse")
+	{
+		std::string buf = "> ";
+		t.render_into(buf, d);
+		REQUIRE(buf == "> Hi Bob, Bob! ${name} $5");
+
+		d.clear();
+		d.set("name", "Al");
+		buf.clear();
+		t.render_into(buf, d);
+		REQUIRE(buf == "Hi Al, Al! ${name} $5");
+	}
+
+	SECTION("unused list")
+	{
+		hol::text_template p{"<h1>${title}</h1>"};
+		hol::text_template::data pd{p};
+		pd.set("title", "Page");
+
+		// items of a list the template does not use go nowhere
+		pd.add("items").set("title", "one").flag("title", false).add("more").set("title", "two");
+		pd.add("items", "three");
+		pd.root().add(p.slot_count()).set("title", "four");
+
+		REQUIRE(p.render(pd) == "<h1>Page</h1>");
+	}
+
+	SECTION("plain")
+	{
+		hol::text_template p{"no tags here"};
+		hol::text_template::data pd{p};
+		REQUIRE(p.render(pd) == "no tags here");
+		REQUIRE(p.size() == 1);
+	}
+}
+
+TEST_CASE("Sections", "[text_template]")
+{
+	SECTION("loops")
+	{
+		hol::text_template t{"${title}:${#items} ${name}(${title})${/items}."};
+		hol::text_template::data d{t};
+		d.set("title", "list");
+
+		REQUIRE(t.render(d) == "list:.");
+
+		d.add("items").set("name", "a");
+		d.add("items").set("name", "b").set("title", "inner");
+
+		// names not set in an item come from the enclosing scope
+		REQUIRE(t.render(d) == "list: a(list) b(inner).");
+	}
+
+	SECTION("nested")
+	{
+		hol::text_template t{"${#rows}[${#cols}${.}${/cols}]${/rows}"};
+		hol::text_template::data d{t};
+
+		auto r1 = d.add("rows");
+		r1.add("cols", "1");
+		r1.add("cols", "2");
+		d.add("rows").add("cols", "3");
+
+		REQUIRE(t.render(d) == "[12][3]");
+	}
+
+	SECTION("conditionals")
+	{
+		hol::text_template t{"${?admin}admin ${/admin}${!admin}user ${/admin}${#name}<${name}>${/name}"};
+		hol::text_template::data d{t};
+
+		REQUIRE(t.render(d) == "user ");
+
+		d.flag("admin").set("name", "root");
+		REQUIRE(t.render(d) == "admin <root>");
+
+		d.flag("admin", false).set("name", "");
+		REQUIRE(t.render(d) == "user ");
+	}
+}
+
+TEST_CASE("Filters", "[text_template]")
+{
+	hol::text_template t{"${v|html}|${v|url}|${v | json}"};
+	hol::text_template::data d{t};
+
+	d.set("v", "a<b> & \"c\"\n");
+	REQUIRE(t.render(d) == "a&lt;b&gt; &amp; &quot;c&quot;\n|a%3Cb%3E%20%26%20%22c%22%0A|a<b> & \\\"c\\\"\\n");
+
+	d.set("v", std::string("x\x01-_.~", 6));
+	REQUIRE(t.render(d) == "x\x01-_.~|x%01-_.~|x\\u0001-_.~");
+}
+
+TEST_CASE("Errors", "[text_template]")
+{
+	REQUIRE_THROWS_AS(hol::text_template{"${open"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${#a}"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${#a}${/b}"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${/a}"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${a|bold}"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${#a|html}${/a}"}, std::invalid_argument);
+	REQUIRE_THROWS_AS(hol::text_template{"${}"}, std::invalid_argument);
+
+	hol::text_template a{"${a}"};
+	hol::text_template b{"${a}${b}"};
+	hol::text_template::data d{a};
+	REQUIRE_THROWS_AS(b.render(d), std::invalid_argument);
+}
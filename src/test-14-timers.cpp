@@ -0,0 +1,286 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hol/timers.h"
+
+namespace hol {
+	using namespace header_only_library::timers;
+}
+
+std::size_t count_of(std::string const& s, std::string const& what)
+{
+	std::size_t n = 0;
+	for(auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + what.size()))
+		++n;
+	return n;
+}
+
+TEST_CASE("Trace scopes", "[tracing]")
+{
+	hol::clear_trace();
+
+	SECTION("spans across threads")
+	{
+		hol::trace_thread_name("main");
+
+		{
+			HOL_TRACE_SCOPE("outer");
+
+			std::thread t([]{
+				hol::trace_thread_name("worker");
+				for(auto i = 0; i < 3; ++i)
+				{
+					HOL_TRACE_SCOPE("inner");
+				}
+			});
+
+			t.join();
+		}
+
+		std::ostringstream oss;
+		hol::write_chrome_trace(oss);
+		auto json = oss.str();
+
+		REQUIRE(json.find("{\"traceEvents\":[") == 0);
+		REQUIRE(count_of(json, "\"name\":\"outer\"") == 1);
+		REQUIRE(count_of(json, "\"name\":\"inner\"") == 3);
+		REQUIRE(count_of(json, "\"ph\":\"X\"") == 4);
+		REQUIRE(count_of(json, "\"name\":\"worker\"") == 1);
+		REQUIRE(count_of(json, "\"name\":\"main\"") == 1);
+	}
+
+	SECTION("ring buffer keeps the newest spans")
+	{
+		hol::trace_buffer buffer{1};
+		std::size_t const capacity = hol::trace_buffer::capacity;
+
+		for(std::uint64_t i = 0; i < capacity + 10; ++i)
+			buffer.record("span", i, i + 1);
+
+		auto records = buffer.snapshot();
+
+		REQUIRE(records.size() == capacity);
+		REQUIRE(records.front().beg == 10);
+		REQUIRE(records.back().beg == capacity + 9);
+	}
+
+	SECTION("snapshots never return torn spans")
+	{
+		hol::trace_buffer buffer{1};
+		std::atomic<bool> done{false};
+
+		std::thread writer([&]{
+			for(std::uint64_t i = 0; i < 2000000; ++i)
+				buffer.record("span", i, 2 * i + 1);
+			done = true;
+		});
+
+		bool ok = true;
+		while(!done)
+		{
+			auto const records = buffer.snapshot();
+			for(std::size_t i = 0; i < records.size(); ++i)
+				ok = ok && records[i].end == 2 * records[i].beg + 1
+					&& (!i || records[i].beg > records[i - 1].beg);
+		}
+
+		writer.join();
+
+		REQUIRE(ok);
+		std::size_t const capacity = hol::trace_buffer::capacity;
+		REQUIRE(buffer.snapshot().size() == capacity);
+	}
+
+	SECTION("buffers of exited threads are reused")
+	{
+		// make sure a released buffer exists
+		std::thread([]{ HOL_TRACE_SCOPE("first"); }).join();
+
+		auto const buffers = header_only_library::timers::detail::trace_registry::instance().all().size();
+
+		for(auto i = 0; i < 20; ++i)
+			std::thread([]{ HOL_TRACE_SCOPE("churn"); }).join();
+
+		REQUIRE(header_only_library::timers::detail::trace_registry::instance().all().size() == buffers);
+
+		// only the last thread's span survives in the reused buffer
+		std::ostringstream oss;
+		hol::write_chrome_trace(oss);
+		REQUIRE(count_of(oss.str(), "\"name\":\"churn\"") == 1);
+	}
+
+	SECTION("names are escaped")
+	{
+		{
+			HOL_TRACE_SCOPE("say \"hi\"");
+		}
+
+		std::ostringstream oss;
+		hol::write_chrome_trace(oss);
+
+		REQUIRE(count_of(oss.str(), "\"name\":\"say \\\"hi\\\"\"") == 1);
+	}
+}
+
+TEST_CASE("Timing wheel", "[timer_wheel]")
+{
+	using std::chrono::milliseconds;
+
+	SECTION("timers fire in order after whole ticks")
+	{
+		hol::timer_wheel wheel{milliseconds(10)};
+		std::vector<int> fired;
+
+		wheel.schedule(milliseconds(30), [&]{ fired.push_back(3); });
+		wheel.schedule(milliseconds(1), [&]{ fired.push_back(1); });
+		wheel.schedule(milliseconds(15), [&]{ fired.push_back(2); });
+
+		REQUIRE(wheel.size() == 3);
+
+		wheel.advance();
+		REQUIRE(fired == std::vector<int>{1});
+		wheel.advance();
+		REQUIRE(fired == (std::vector<int>{1, 2}));
+		wheel.advance();
+		REQUIRE(fired == (std::vector<int>{1, 2, 3}));
+		REQUIRE(wheel.size() == 0);
+	}
+
+	SECTION("cancel and reschedule")
+	{
+		hol::timer_wheel wheel;
+		int fired = 0;
+
+		auto a = wheel.schedule(milliseconds(5), [&]{ ++fired; });
+		auto b = wheel.schedule(milliseconds(5), [&]{ fired += 10; });
+
+		REQUIRE(wheel.cancel(a));
+		REQUIRE(!wheel.cancel(a));
+
+		wheel.advance(3);
+		REQUIRE(wheel.reschedule(b, milliseconds(5)));
+
+		wheel.advance(4);
+		REQUIRE(fired == 0);
+		wheel.advance();
+		REQUIRE(fired == 10);
+
+		REQUIRE(!wheel.reschedule(b, milliseconds(5)));
+
+		// stale ids don't match reused slots
+		auto c = wheel.schedule(milliseconds(1), [&]{ fired += 100; });
+		REQUIRE(c != a);
+		REQUIRE(!wheel.cancel(a));
+		wheel.advance();
+		REQUIRE(fired == 110);
+	}
+
+	SECTION("timers cascade down from the higher levels")
+	{
+		hol::timer_wheel wheel;
+		std::vector<std::uint64_t> expected = {255, 256, 257, 1000, 65536, 70000};
+		std::vector<std::uint64_t> fired;
+		std::uint64_t now = 0;
+
+		for(auto t: expected)
+			wheel.schedule(milliseconds(t), [&, t]{ REQUIRE(now == t); fired.push_back(t); });
+
+		while(now < 70000)
+		{
+			++now;
+			wheel.advance();
+		}
+
+		REQUIRE(fired == expected);
+	}
+
+	SECTION("threaded wheel runs callbacks")
+	{
+		hol::timer_wheel wheel{milliseconds(1)};
+		wheel.start();
+
+		std::mutex mtx;
+		std::condition_variable cv;
+		int fired = 0;
+
+		for(int i = 0; i < 10; ++i)
+		{
+			wheel.schedule(milliseconds(i * 2), [&]
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				++fired;
+				cv.notify_all();
+			});
+		}
+
+		auto never = wheel.schedule(std::chrono::seconds(60), []{});
+
+		std::unique_lock<std::mutex> lock(mtx);
+		REQUIRE(cv.wait_for(lock, std::chrono::seconds(5), [&]{ return fired == 10; }));
+		lock.unlock();
+
+		REQUIRE(wheel.cancel(never));
+		wheel.stop();
+	}
+}
+
+#ifdef HOL_HAS_RDTSC
+
+TEST_CASE("TSC timer", "[rdtsc]")
+{
+	SECTION("agrees with the monotonic clock")
+	{
+		hol::RdtscTimer tsc;
+		hol::LinuxTimer raw;
+
+		raw.start();
+		tsc.start();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		tsc.stop();
+		raw.stop();
+
+		REQUIRE(tsc.nsecs() > 0);
+		REQUIRE(tsc.nsecs() < raw.nsecs() * 11 / 10);
+		REQUIRE(tsc.nsecs() > raw.nsecs() * 9 / 10);
+	}
+
+	SECTION("cleared timer reads zero")
+	{
+		hol::RdtscTimer tsc;
+		tsc.clear();
+		REQUIRE(tsc.nsecs() == 0);
+	}
+}
+
+#endif // HOL_HAS_RDTSC
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2016 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hol/string_tokenizer.h"
+
+namespace hol{
+	using namespace header_only_library::string_utils;
+}
+
+template<typename Tokenizer>
+static std::vector<std::string> drain(Tokenizer& st)
+{
+	std::vector<std::string> v;
+	std::string s;
+	while(st >> s)
+		v.push_back(s);
+	return v;
+}
+
+using strings = std::vector<std::string>;
+
+TEST_CASE("string_tokenizer delimiters", "[string_tokenizer]")
+{
+	SECTION("plain")
+	{
+		hol::string_tokenizer st("a b c");
+		REQUIRE(drain(st) == (strings{"a", "b", "c"}));
+	}
+
+	SECTION("leading")
+	{
+		hol::string_tokenizer st("  a b");
+		REQUIRE(drain(st) == (strings{"a", "b"}));
+	}
+
+	SECTION("trailing")
+	{
+		hol::string_tokenizer st("a b  ");
+		REQUIRE(drain(st) == (strings{"a", "b"}));
+	}
+
+	SECTION("repeated")
+	{
+		hol::string_tokenizer st("a   b \t c", " \t");
+		REQUIRE(drain(st) == (strings{"a", "b", "c"}));
+	}
+
+	SECTION("only delimiters")
+	{
+		hol::string_tokenizer st("   ");
+		REQUIRE(st.eot());
+		REQUIRE(drain(st).empty());
+	}
+
+	SECTION("empty")
+	{
+		hol::string_tokenizer st("");
+		REQUIRE(st.eot());
+		REQUIRE(drain(st).empty());
+	}
+}
+
+TEST_CASE("string_tokenizer views", "[string_tokenizer]")
+{
+	std::string const text = ",x,,yz,";
+	hol::string_tokenizer st(std::string_view(text), ",");
+
+	std::string_view sv;
+
+	REQUIRE(st.next(sv));
+	REQUIRE(sv == "x");
+	REQUIRE(sv.data() == text.data() + 1);
+
+	REQUIRE(st.next(sv));
+	REQUIRE(sv == "yz");
+	REQUIRE(sv.data() == text.data() + 4);
+
+	REQUIRE(st.eot());
+	REQUIRE(!st.next(sv));
+}
+
+TEST_CASE("string_tokenizer char_set", "[string_tokenizer]")
+{
+	hol::string_tokenizer::char_set const ws(" \t");
+
+	hol::string_tokenizer st("k1=v1 \t k2=v2", "=");
+
+	std::string k, v;
+
+	REQUIRE(st.next(k));
+	REQUIRE(st.next(v, ws));
+	REQUIRE(k == "k1");
+	REQUIRE(v == "v1");
+
+	REQUIRE(st.next(k));
+	REQUIRE(st.next(v, " "));
+	REQUIRE(k == "k2");
+	REQUIRE(v == "v2");
+
+	REQUIRE(!st.next(k));
+}
+
+TEST_CASE("string_tokenizer rewind", "[string_tokenizer]")
+{
+	hol::string_tokenizer st(" , a, b ,", " ,");
+
+	REQUIRE(drain(st) == (strings{"a", "b"}));
+	REQUIRE(!st);
+
+	st.rewind();
+
+	REQUIRE(st);
+	REQUIRE(!st.eot());
+
+	std::string s;
+	REQUIRE(st >> s);
+	REQUIRE(s == "a");
+
+	st.rewind();
+	REQUIRE(st >> s);
+	REQUIRE(s == "a");
+	REQUIRE(st >> s);
+	REQUIRE(s == "b");
+	REQUIRE(!(st >> s));
+}
+
+TEST_CASE("wstring_tokenizer", "[string_tokenizer]")
+{
+	hol::wstring_tokenizer st(L" one  two ");
+
+	std::wstring s;
+	REQUIRE(st >> s);
+	REQUIRE(s == L"one");
+	REQUIRE(st >> s);
+	REQUIRE(s == L"two");
+	REQUIRE(!(st >> s));
+}
@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string>
+#include <vector>
+
+#include "hol/benchmark_utils.h"
+#include "hol/string_utils.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::string_utils;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	std::vector<std::string> const small(10, "field");
+	std::vector<std::string> const large(1000, "a somewhat longer field");
+
+	bench.run("join/10", [&]{
+		hol::do_not_optimize(hol::join(std::begin(small), std::end(small), ","));
+	});
+
+	bench.run("join/1000", [&]{
+		hol::do_not_optimize(hol::join(std::begin(large), std::end(large), ", "));
+	});
+
+	bench.run("join/1000_empty_delim", [&]{
+		hol::do_not_optimize(hol::join(std::begin(large), std::end(large), ""));
+	});
+
+	std::string buffer;
+	bench.run("join_into/1000_reused", [&]{
+		buffer.clear();
+		hol::do_not_optimize(hol::join_into(buffer, large, ", "));
+	});
+
+	bench.report();
+}
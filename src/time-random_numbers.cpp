@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <vector>
+
+#include "hol/benchmark_utils.h"
+#include "hol/random_numbers.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::random_numbers;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	std::vector<int> v(1000);
+
+	bench.run("random_number/int_range", [&]{ hol::do_not_optimize(hol::random_number(1, 100)); });
+	bench.run("random_number/int_to", [&]{ hol::do_not_optimize(hol::random_number(100)); });
+	bench.run("random_number/double_range", [&]{ hol::do_not_optimize(hol::random_number(0.0, 1.0)); });
+	bench.run("random_choice", [&]{ hol::do_not_optimize(hol::random_choice()); });
+	bench.run("random_element/1000", [&]{ hol::do_not_optimize(hol::random_element(v)); });
+	bench.run("random_shuffle/1000", [&]{ hol::random_shuffle(v); hol::do_not_optimize(v); });
+
+	bench.report();
+}
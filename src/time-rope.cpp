@@ -0,0 +1,64 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string>
+
+#include "hol/benchmark_utils.h"
+#include "hol/random_numbers.h"
+#include "hol/rope.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::rope_utils;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	for(std::size_t size: {1000UL, 100000UL, 1000000UL})
+	{
+		hol::rope const text(size, 'x');
+		auto suffix = "/" + std::to_string(size);
+
+		bench.run("rope_insert/middle" + suffix, [&]{
+			auto r = text;
+			r.insert(size / 2, "inserted text");
+			hol::do_not_optimize(r);
+		});
+
+		bench.run("rope_insert/random_x100" + suffix, [&]{
+			auto r = text;
+			for(auto i = 0; i < 100; ++i)
+				r.insert(hol::random_number(r.size()), "abc");
+			hol::do_not_optimize(r);
+		});
+
+		bench.run("rope_copy" + suffix, [&]{
+			auto r = text;
+			hol::do_not_optimize(r);
+		});
+	}
+
+	bench.report();
+}
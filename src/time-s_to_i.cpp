@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string>
+#include <vector>
+
+#include "hol/benchmark_utils.h"
+#include "hol/random_numbers.h"
+#include "hol/string_utils.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::string_conversions;
+	using namespace header_only_library::string_utils;
+}
+
+template<typename Integer>
+std::vector<std::string> random_numbers(std::size_t n, Integer from, Integer to)
+{
+	std::vector<std::string> v;
+	for(std::size_t i = 0; i < n; ++i)
+		v.push_back(std::to_string(hol::random_number(from, to)));
+	return v;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	auto const shorts = random_numbers<int>(1000, -999, 999);
+	auto const ints = random_numbers<int>(1000, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+	auto const longs = random_numbers<long long>(1000, std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max());
+	auto const unsigneds = random_numbers<unsigned long long>(1000, 0, std::numeric_limits<unsigned long long>::max());
+
+	bench.run("s_to_i/int_3_digit_x1000", [&]{
+		int i;
+		for(auto const& s: shorts)
+			hol::do_not_optimize(hol::s_to_i(s, i));
+	});
+
+	bench.run("s_to_i/int_x1000", [&]{
+		int i;
+		for(auto const& s: ints)
+			hol::do_not_optimize(hol::s_to_i(s, i));
+	});
+
+	bench.run("s_to_i/long_long_x1000", [&]{
+		long long i;
+		for(auto const& s: longs)
+			hol::do_not_optimize(hol::s_to_i(s, i));
+	});
+
+	bench.run("s_to_u/unsigned_long_long_x1000", [&]{
+		unsigned long long u;
+		for(auto const& s: unsigneds)
+			hol::do_not_optimize(hol::s_to_u(s, u));
+	});
+
+	bench.run("from_chars/long_long_x1000", [&]{
+		long long i;
+		for(auto const& s: longs)
+			hol::do_not_optimize(hol::from_chars(s, i));
+	});
+
+	bench.run("parse_fields/long_long_x1000", [&]{
+		long long out[1000];
+		std::uint64_t errors[16];
+		hol::do_not_optimize(hol::parse_fields(longs.begin(), longs.end(), out, errors));
+		hol::do_not_optimize(out);
+	});
+
+	bench.run("std::stoll/long_long_x1000", [&]{
+		for(auto const& s: longs)
+			hol::do_not_optimize(std::stoll(s));
+	});
+
+	bench.report();
+}
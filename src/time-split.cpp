@@ -0,0 +1,62 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string>
+
+#include "hol/benchmark_utils.h"
+#include "hol/random_numbers.h"
+#include "hol/string_utils.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::random_numbers;
+	using namespace header_only_library::string_utils;
+}
+
+std::string random_row(std::size_t fields, std::string const& delim)
+{
+	std::string s;
+	for(std::size_t i = 0; i < fields; ++i)
+	{
+		if(i)
+			s += delim;
+		s += std::to_string(hol::random_number(1000000));
+	}
+	return s;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	auto const csv = random_row(20, ",");
+	auto const tsv = random_row(20, "\t");
+	auto const sep = random_row(20, "||");
+	auto const spaced = random_row(20, "   ");
+
+	bench.run("split/csv_20", [&]{ hol::do_not_optimize(hol::split(csv, ",")); });
+	bench.run("split/tsv_20", [&]{ hol::do_not_optimize(hol::split(tsv, "\t")); });
+	bench.run("split/multi_char_20", [&]{ hol::do_not_optimize(hol::split(sep, "||")); });
+	bench.run("split_fold/spaces_20", [&]{ hol::do_not_optimize(hol::split_fold(spaced, " ")); });
+
+	bench.report();
+}
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "hol/benchmark_utils.h"
+#include "hol/thread_utils.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::thread_utils;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	std::vector<unsigned> sizes = {1U, 2U, 4U, std::thread::hardware_concurrency()};
+	std::sort(std::begin(sizes), std::end(sizes));
+	sizes.erase(std::unique(std::begin(sizes), std::end(sizes)), std::end(sizes));
+
+	for(auto threads: sizes)
+	{
+		hol::thread_pool pool;
+		pool.start(threads);
+
+		std::atomic<std::size_t> done{0};
+
+		// time to push and complete 1000 tiny jobs
+		bench.run("thread_pool/1000_jobs/" + std::to_string(threads) + "_threads", [&]{
+			done = 0;
+
+			for(auto i = 0; i < 1000; ++i)
+				pool.add([&done]{ ++done; });
+
+			while(done < 1000)
+				std::this_thread::yield();
+		});
+
+		pool.stop();
+	}
+
+	bench.report();
+}
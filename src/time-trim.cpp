@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2017 Galik <galik.bool@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string>
+
+#include "hol/benchmark_utils.h"
+#include "hol/string_utils.h"
+
+namespace hol {
+	using namespace header_only_library::benchmark_utils;
+	using namespace header_only_library::string_utils;
+}
+
+int main(int argc, char* argv[])
+{
+	hol::benchmark_runner bench(argc, argv);
+
+	std::string const short_field = " \t value \n";
+	std::string const long_field = std::string(64, ' ') + std::string(256, 'x') + std::string(64, ' ');
+	std::string const no_space = std::string(256, 'x');
+
+	bench.run("trim_copy/short", [&]{ hol::do_not_optimize(hol::trim_copy(short_field)); });
+	bench.run("trim_copy/long", [&]{ hol::do_not_optimize(hol::trim_copy(long_field)); });
+	bench.run("trim_copy/no_space", [&]{ hol::do_not_optimize(hol::trim_copy(no_space)); });
+	bench.run("trim_left_copy/long", [&]{ hol::do_not_optimize(hol::trim_left_copy(long_field, " ")); });
+	bench.run("trim_right_copy/long", [&]{ hol::do_not_optimize(hol::trim_right_copy(long_field)); });
+
+	bench.run("trim_mute/long", [&]{
+		auto s = long_field;
+		hol::do_not_optimize(hol::trim_mute(s));
+	});
+
+	bench.report();
+}